@@ -1,5 +1,4 @@
 #include "generated/Calc_types.h"
-#include <future>
 #include <exception>
 #include <sstream>
 #include <iostream>
@@ -11,11 +10,11 @@ namespace Calc
     {
     public:
         template <typename Callback>
-        void operator()(std::future<Request> request, Callback&& callback)
+        void operator()(Request&& request, Callback&& callback)
         {
             try
             {
-                callback(Process(request.get()));
+                callback(Process(request));
             }
             catch (const std::exception& e)
             {
@@ -23,6 +22,19 @@ namespace Calc
             }
         }
 
+        template <typename Callback>
+        void operator()(std::exception_ptr error, Callback&& /*callback*/)
+        {
+            try
+            {
+                std::rethrow_exception(error);
+            }
+            catch (const std::exception& e)
+            {
+                std::cout << "Failed to receive request: " << e.what() << std::endl;
+            }
+        }
+
     private:
         Response Process(const Request& request)
         {
@@ -24,15 +24,18 @@ namespace Bond
         ChannelSettings<Traits> channelSettings = {},
         std::size_t minBlobSize = 0,
         std::size_t hostInfoMemorySize = 0,
-        ErrorHandler&& errorHandler = {})
+        ErrorHandler&& errorHandler = {},
+        typename Traits::DeserializationScheduler scheduler = {},
+        typename Traits::ResponseCache cache = {})
     {
         return IPC::detail::Accept<ServerAcceptor<Request, Response, Traits>>(
             name,
             std::make_shared<ServerCollection<Server<Request, Response, Traits>>>(),
-            [protocol, marshal, minBlobSize, handlerFactory = std::forward<HandlerFactory>(handlerFactory)](auto&& connection, auto&& closeHandler) mutable
+            [protocol, marshal, minBlobSize, handlerFactory = std::forward<HandlerFactory>(handlerFactory), scheduler = std::move(scheduler), cache = std::move(cache)](
+                auto&& connection, auto&& closeHandler) mutable
             {
                 return MakeServer<Request, Response, Traits>(
-                    std::move(connection), handlerFactory, std::forward<decltype(closeHandler)>(closeHandler), protocol, marshal, minBlobSize);
+                    std::move(connection), handlerFactory, std::forward<decltype(closeHandler)>(closeHandler), protocol, marshal, minBlobSize, scheduler, cache);
             },
             std::forward<ErrorHandler>(errorHandler),
             std::move(channelSettings),
@@ -49,14 +52,15 @@ namespace Bond
         std::size_t minBlobSize = 0,
         std::size_t hostInfoMemorySize = 0,
         ErrorHandler&& errorHandler = {},
-        typename Traits::TransactionManagerFactory transactionManagerFactory = {})
+        typename Traits::TransactionManagerFactory transactionManagerFactory = {},
+        typename Traits::DeserializationScheduler scheduler = {})
     {
         using Client = Client<Request, Response, Traits>;
 
         return IPC::detail::Accept<ClientAcceptor<Request, Response, Traits>>(
             name,
             std::make_shared<ClientCollection<Client>>(),
-            [protocol, marshal, minBlobSize, transactionManagerFactory = std::move(transactionManagerFactory)](auto&& connection, auto&& closeHandler)
+            [protocol, marshal, minBlobSize, transactionManagerFactory = std::move(transactionManagerFactory), scheduler = std::move(scheduler)](auto&& connection, auto&& closeHandler)
             {
                 return MakeClient<Request, Response, Traits>(
                     std::move(connection),
@@ -64,7 +68,8 @@ namespace Bond
                     protocol,
                     marshal,
                     minBlobSize,
-                    transactionManagerFactory(IPC::detail::Identity<typename Client::TransactionManager>{}));
+                    transactionManagerFactory(IPC::detail::Identity<typename Client::TransactionManager>{}),
+                    scheduler);
             },
             std::forward<ErrorHandler>(errorHandler),
             std::move(channelSettings),
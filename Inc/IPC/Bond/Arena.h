@@ -0,0 +1,258 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+
+namespace IPC
+{
+namespace Bond
+{
+    // Bump allocator which releases all of its allocations at once on Reset. Chunks are kept for reuse.
+    class MonotonicArena
+    {
+    public:
+        explicit MonotonicArena(std::size_t chunkSize = 64 * 1024)
+            : m_chunkSize{ (std::max)(chunkSize, std::size_t{ 1 }) }
+        {}
+
+        MonotonicArena(const MonotonicArena& other) = delete;
+        MonotonicArena& operator=(const MonotonicArena& other) = delete;
+
+        void* Allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t))
+        {
+            while (m_current < m_chunks.size())
+            {
+                auto& chunk = m_chunks[m_current];
+
+                auto address = reinterpret_cast<std::uintptr_t>(chunk.m_data.get()) + m_offset;
+                auto padding = (alignment - address % alignment) % alignment;
+
+                if (m_offset + padding + size <= chunk.m_size)
+                {
+                    m_offset += padding + size;
+                    m_allocatedSize += size;
+                    return reinterpret_cast<void*>(address + padding);
+                }
+
+                ++m_current;
+                m_offset = 0;
+            }
+
+            auto chunkSize = (std::max)(m_chunkSize, size + alignment);
+            m_chunks.push_back(Chunk{ std::make_unique<char[]>(chunkSize), chunkSize });
+
+            return Allocate(size, alignment);
+        }
+
+        void Reset()
+        {
+            m_current = 0;
+            m_offset = 0;
+            m_allocatedSize = 0;
+        }
+
+        std::size_t GetAllocatedSize() const
+        {
+            return m_allocatedSize;
+        }
+
+        std::size_t GetReservedSize() const
+        {
+            std::size_t size = 0;
+
+            for (const auto& chunk : m_chunks)
+            {
+                size += chunk.m_size;
+            }
+
+            return size;
+        }
+
+    private:
+        struct Chunk
+        {
+            std::unique_ptr<char[]> m_data;
+            std::size_t m_size;
+        };
+
+        std::vector<Chunk> m_chunks;
+        std::size_t m_chunkSize;
+        std::size_t m_current{ 0 };
+        std::size_t m_offset{ 0 };
+        std::size_t m_allocatedSize{ 0 };
+    };
+
+
+    // Default constructed allocators fall back to the global heap.
+    template <typename T>
+    class ArenaAllocator
+    {
+    public:
+        using value_type = T;
+
+        ArenaAllocator() = default;
+
+        ArenaAllocator(MonotonicArena& arena) noexcept
+            : m_arena{ &arena }
+        {}
+
+        template <typename U>
+        ArenaAllocator(const ArenaAllocator<U>& other) noexcept
+            : m_arena{ other.GetArena() }
+        {}
+
+        T* allocate(std::size_t count)
+        {
+            return m_arena
+                ? static_cast<T*>(m_arena->Allocate(count * sizeof(T), alignof(T)))
+                : static_cast<T*>(::operator new(count * sizeof(T)));
+        }
+
+        void deallocate(T* ptr, std::size_t /*count*/) noexcept
+        {
+            if (!m_arena)
+            {
+                ::operator delete(ptr);
+            }
+        }
+
+        MonotonicArena* GetArena() const noexcept
+        {
+            return m_arena;
+        }
+
+        template <typename U>
+        bool operator==(const ArenaAllocator<U>& other) const noexcept
+        {
+            return m_arena == other.GetArena();
+        }
+
+        template <typename U>
+        bool operator!=(const ArenaAllocator<U>& other) const noexcept
+        {
+            return !(*this == other);
+        }
+
+    private:
+        MonotonicArena* m_arena{ nullptr };
+    };
+
+
+    // Object pool policy for types generated with a custom allocator (T::allocator_type constructible from
+    // MonotonicArena&). Every object gets its own arena which is reset wholesale once the holder is released,
+    // so handlers must not keep the object after they return. Strings and containers moved or copy constructed
+    // out of it keep the arena allocator and dangle after the reset too, values that outlive the call must be
+    // assigned to ones holding a default constructed allocator.
+    template <typename T, std::size_t Capacity = 64, std::size_t ChunkSize = 64 * 1024>
+    class ArenaObjectPool
+    {
+        struct State
+        {
+            std::mutex m_lock;
+            std::vector<std::unique_ptr<MonotonicArena>> m_arenas;
+        };
+
+    public:
+        class Recycler
+        {
+        public:
+            Recycler() = default;
+
+            void operator()(MonotonicArena* ptr) const
+            {
+                std::unique_ptr<MonotonicArena> arena{ ptr };
+
+                if (!m_state)
+                {
+                    return;
+                }
+
+                arena->Reset();
+
+                std::lock_guard<std::mutex> guard{ m_state->m_lock };
+
+                if (m_state->m_arenas.size() < Capacity)
+                {
+                    m_state->m_arenas.push_back(std::move(arena));
+                }
+            }
+
+        private:
+            friend ArenaObjectPool;
+
+            explicit Recycler(std::shared_ptr<State> state)
+                : m_state{ std::move(state) }
+            {}
+
+            std::shared_ptr<State> m_state;
+        };
+
+        class Holder
+        {
+        public:
+            T& operator*()
+            {
+                return m_value;
+            }
+
+            T* operator->()
+            {
+                return &m_value;
+            }
+
+            MonotonicArena& GetArena() const
+            {
+                return *m_arena;
+            }
+
+        private:
+            friend ArenaObjectPool;
+
+            explicit Holder(std::unique_ptr<MonotonicArena, Recycler> arena)
+                : m_arena{ std::move(arena) },
+                  m_value{ typename T::allocator_type{ *m_arena } }
+            {}
+
+            std::unique_ptr<MonotonicArena, Recycler> m_arena;   // Must outlive the value.
+            T m_value;
+        };
+
+        Holder Take() const
+        {
+            std::unique_ptr<MonotonicArena> arena;
+            {
+                std::lock_guard<std::mutex> guard{ m_state->m_lock };
+
+                if (!m_state->m_arenas.empty())
+                {
+                    arena = std::move(m_state->m_arenas.back());
+                    m_state->m_arenas.pop_back();
+                }
+            }
+
+            if (!arena)
+            {
+                arena = std::make_unique<MonotonicArena>(ChunkSize);
+            }
+
+            return Holder{ std::unique_ptr<MonotonicArena, Recycler>{ arena.release(), Recycler{ m_state } } };
+        }
+
+        std::size_t GetAvailableCount() const
+        {
+            std::lock_guard<std::mutex> guard{ m_state->m_lock };
+            return m_state->m_arenas.size();
+        }
+
+    private:
+        std::shared_ptr<State> m_state{ std::make_shared<State>() };
+    };
+
+} // Bond
+} // IPC
@@ -21,7 +21,10 @@ namespace Bond
         assert(memory && memory->Contains(data) && memory->Contains(data + size - 1));
 
         return{
-            boost::shared_ptr<const char[]>{ data, detail::BlobHolder<std::decay_t<Blob>>{ std::forward<Blob>(from), std::move(memory) } },
+            boost::shared_ptr<const char[]>{
+                data,
+                detail::BlobHolder<std::decay_t<Blob>>{ std::forward<Blob>(from), std::move(memory) },
+                detail::PooledAllocator<char>{} },
             static_cast<std::uint32_t>(size) };
     }
 
@@ -39,5 +42,37 @@ namespace Bond
         return{};
     }
 
+
+    // Remembers the holder of the last cast blob, so casting blobs which share it (e.g. the ones
+    // read from the same message) costs an ownership comparison instead of a deleter lookup.
+    template <typename Blob>
+    class BlobCastCache
+    {
+    public:
+        Blob operator()(const bond::blob& from)
+        {
+            auto hook = bond::blob_cast<detail::BlobHook>(from);
+
+            if (!hook)
+            {
+                return{};
+            }
+
+            if (m_hook.owner_before(hook) || hook.owner_before(m_hook))
+            {
+                auto deleter = boost::get_deleter<detail::BlobHolder<Blob>>(hook);
+
+                m_blob = deleter ? deleter->m_blob : Blob{};
+                m_hook = std::move(hook);
+            }
+
+            return m_blob ? m_blob.GetRange(std::distance(m_blob.data(), from.content()), from.size()) : Blob{};
+        }
+
+    private:
+        detail::BlobHook m_hook;    // Keeps the holder alive, so its identity is not reused.
+        Blob m_blob;
+    };
+
 } // Bond
 } // IPC
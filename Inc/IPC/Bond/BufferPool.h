@@ -3,7 +3,20 @@
 #include "BufferPoolFwd.h"
 #include "IPC/SharedMemory.h"
 #include "IPC/detail/LockFree/Queue.h"
+#include "detail/LockFreeStack.h"
+#include "detail/AlignedAllocator.h"
+#include "detail/ProtocolNegotiation.h"
+#include <boost/container/vector.hpp>
 #include <boost/interprocess/containers/vector.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 
 namespace IPC
@@ -23,6 +36,8 @@ namespace Bond
 
         SharedMemory::SharedPtr<Data> Take()
         {
+            ReleasePins();
+
             if (auto data = m_queue->Pop())
             {
                 return std::move(*data);
@@ -41,22 +56,114 @@ namespace Bond
             return m_memory;
         }
 
+        void EnablePeerReferences(std::shared_ptr<SharedMemory> peerMemory, std::size_t minSize)
+        {
+            auto& anchor = peerMemory->FindOrConstruct<std::uint64_t>(ReferenceAnchorName);
+            m_references = std::make_unique<PeerReferences>(
+                std::move(peerMemory), minSize, anchor, m_memory->MakeShared<Queue>(anonymous_instance, m_memory->GetAllocator<char>()));
+        }
+
+        // Reference blobs are recycled through their own queue, so their pins are released as soon as this pool
+        // is used again after the last holder, in any process, freed them. The pins live in the peer memory and
+        // are owned by this process, hence they cannot be released by whichever process freed the reference.
+        void ReleasePins()
+        {
+            if (m_references)
+            {
+                while (auto data = m_references->m_freed->Pop())
+                {
+                    {
+                        std::lock_guard<std::mutex> guard{ m_references->m_lock };
+                        m_references->m_pins.erase(&**data);
+                    }
+
+                    m_queue->Push(std::move(*data));
+                }
+            }
+        }
+
+        const auto& GetPeerReferences() const
+        {
+            return m_references;
+        }
+
+        const char* GetReferenceAnchor()
+        {
+            auto anchor = m_anchor.load(std::memory_order_acquire);
+
+            if (!anchor)
+            {
+                // Constructed by the peer before it sends its first reference.
+                anchor = reinterpret_cast<const char*>(m_memory->Find<std::uint64_t>(ReferenceAnchorName));
+                m_anchor.store(anchor, std::memory_order_release);
+            }
+
+            return anchor;
+        }
+
+        // References are resolved relative to a named object, since segments are mapped at different addresses.
+        static constexpr const char* ReferenceAnchorName = "IPC.Bond.BlobReferenceAnchor";
+
+        struct PeerReferences
+        {
+            // Bounds the peer memory kept alive by references which are never freed, e.g. ones queued on a
+            // connection nobody reads from anymore. Blobs are copied instead once it is reached.
+            static constexpr std::size_t MaxPinCount = 1024;
+
+            PeerReferences(std::shared_ptr<SharedMemory> memory, std::size_t minSize, std::uint64_t& anchor, SharedMemory::SharedPtr<Queue> freed)
+                : m_memory{ std::move(memory) },
+                  m_minSize{ minSize },
+                  m_anchor{ reinterpret_cast<const char*>(&anchor) },
+                  m_freed{ std::move(freed) }
+            {}
+
+            // Checked until the peer is seen to advertise resolving references, see detail::ProtocolNegotiation.
+            bool IsAccepted()
+            {
+                if (!m_isAccepted.load(std::memory_order_acquire) && detail::ProtocolNegotiation::IsPeerReferencesAdvertised(*m_memory))
+                {
+                    m_isAccepted.store(true, std::memory_order_release);
+                }
+
+                return m_isAccepted.load(std::memory_order_acquire);
+            }
+
+            std::shared_ptr<SharedMemory> m_memory;
+            const std::size_t m_minSize;
+            const char* const m_anchor;
+            SharedMemory::SharedPtr<Queue> m_freed;
+            std::atomic_bool m_isAccepted{ false };
+            std::mutex m_lock;
+
+            // Pins keep the referenced blobs alive for as long as anybody holds the reference blob.
+            std::unordered_map<const Data*, SharedMemory::SharedPtr<Pin>> m_pins;
+        };
+
     private:
         std::shared_ptr<SharedMemory> m_memory;
         SharedMemory::SharedPtr<Queue> m_queue;
+        std::atomic<const char*> m_anchor{ nullptr };
+        std::unique_ptr<PeerReferences> m_references;   // Must be declared last.
     };
 
 
+    // Blob payloads start at a cache line and the header is padded, so neither shares a line with the
+    // shared_ptr reference counts or other objects which the peer process updates concurrently.
     template <template <typename> typename QueueT>
     struct BufferPool<QueueT>::Data
     {
+        using BlobAllocator = detail::AlignedAllocator<char, typename SharedMemory::Allocator<char>::segment_manager>;
+
         explicit Data(const SharedMemory::Allocator<char>& allocator)
-            : m_blob{ allocator },
+            : m_blob{ BlobAllocator{ allocator } },
               m_buffer{ allocator }
         {}
 
-        boost::interprocess::vector<char, SharedMemory::Allocator<char>> m_blob;
+        detail::CacheLinePadding m_front;
+        boost::container::vector<char, BlobAllocator> m_blob;
         boost::interprocess::vector<ConstBlob, SharedMemory::Allocator<ConstBlob>> m_buffer;
+        bool m_isReference{ false };    // m_blob holds the offset of a Pin in the peer memory.
+        detail::CacheLinePadding m_back;
     };
 
 
@@ -70,6 +177,7 @@ namespace Bond
             {
                 m_data->m_blob.clear();
                 m_data->m_buffer.clear();
+                m_data->m_isReference = false;
                 m_queue->Push(std::move(m_data));
             }
         }
@@ -79,6 +187,17 @@ namespace Bond
             return m_data && m_queue;
         }
 
+        bool IsReference() const
+        {
+            return m_data->m_isReference;
+        }
+
+        // Returns true when nobody else, in any process, holds the data.
+        bool IsUnique() const
+        {
+            return m_data.unique();
+        }
+
     protected:
         ItemBase() = default;
 
@@ -112,6 +231,11 @@ namespace Bond
             return m_data == other.m_data && m_queue == other.m_queue;
         }
 
+        void SetReference()
+        {
+            m_data->m_isReference = true;
+        }
+
     private:
         SharedMemory::SharedPtr<Data> m_data;
         SharedMemory::SharedPtr<typename Impl::Queue> m_queue;
@@ -159,6 +283,8 @@ namespace Bond
     template <template <typename> typename QueueT>
     class BufferPool<QueueT>::ConstBlob : public ItemBase
     {
+        friend BufferPool;
+
         using Iterator = decltype(std::declval<Data>().m_blob.cbegin());
 
     public:
@@ -316,6 +442,17 @@ namespace Bond
     };
 
 
+    template <template <typename> typename QueueT>
+    struct BufferPool<QueueT>::Pin
+    {
+        explicit Pin(const ConstBlob& blob)
+            : m_blob{ blob }
+        {}
+
+        ConstBlob m_blob;
+    };
+
+
     template <template <typename> typename QueueT>
     BufferPool<QueueT>::BufferPool(std::shared_ptr<SharedMemory> memory)
         : m_impl{ std::make_shared<Impl>(std::move(memory)) }
@@ -339,6 +476,140 @@ namespace Bond
         return m_impl->GetMemory();
     }
 
+    template <template <typename> typename QueueT>
+    void BufferPool<QueueT>::EnablePeerReferences(std::shared_ptr<SharedMemory> peerMemory, std::size_t minSize)
+    {
+        m_impl->EnablePeerReferences(std::move(peerMemory), minSize);
+    }
+
+    template <template <typename> typename QueueT>
+    auto BufferPool<QueueT>::MakeReference(const ConstBlob& blob) -> ConstBlob
+    {
+        const auto& references = m_impl->GetPeerReferences();
+
+        if (!references || !blob || blob.size() < references->m_minSize || !references->m_memory->Contains(blob.data()) || !references->IsAccepted())
+        {
+            return{};
+        }
+
+        {
+            std::lock_guard<std::mutex> guard{ references->m_lock };
+
+            if (references->m_pins.size() >= Impl::PeerReferences::MaxPinCount)
+            {
+                return{};
+            }
+        }
+
+        auto pin = references->m_memory->MakeShared<Pin>(anonymous_instance, blob);
+        const std::int64_t offset = reinterpret_cast<const char*>(&*pin) - references->m_anchor;
+
+        auto data = m_impl->Take();
+        const Data* key = &*data;
+
+        // Returns to the queue of freed references instead of the pool, which releases the pin.
+        Blob reference{ std::move(data), references->m_freed };
+        reference->resize(sizeof(offset), boost::container::default_init);
+        std::memcpy(reference->data(), &offset, sizeof(offset));
+        reference.SetReference();
+
+        {
+            std::lock_guard<std::mutex> guard{ references->m_lock };
+            references->m_pins.emplace(key, std::move(pin));
+        }
+
+        return{ reference };
+    }
+
+    template <template <typename> typename QueueT>
+    auto BufferPool<QueueT>::ResolveReferences(const ConstBuffer& buffer) -> ConstBuffer
+    {
+        if (!buffer || std::none_of(buffer.begin(), buffer.end(), [](const ConstBlob& blob) { return blob && blob.IsReference(); }))
+        {
+            return{};
+        }
+
+        const auto& memory = GetMemory();
+        const auto anchor = m_impl->GetReferenceAnchor();
+
+        auto result = TakeBuffer();
+
+        for (const auto& blob : buffer)
+        {
+            if (!blob || blob.size() == 0)
+            {
+                continue;
+            }
+
+            if (blob.IsReference())
+            {
+                std::int64_t offset;
+
+                if (!anchor || blob.size() != sizeof(offset))
+                {
+                    throw std::runtime_error{ "Invalid blob reference." };
+                }
+
+                std::memcpy(&offset, blob.data(), sizeof(offset));
+
+                auto pin = reinterpret_cast<const Pin*>(anchor + offset);
+
+                if (!memory->Contains(pin) || !memory->Contains(reinterpret_cast<const char*>(pin + 1) - 1))
+                {
+                    throw std::runtime_error{ "Invalid blob reference." };
+                }
+
+                result->push_back(pin->m_blob);
+            }
+            else
+            {
+                result->push_back(blob);
+            }
+        }
+
+        return std::move(result);
+    }
+
+
+    template <typename BufferPool>
+    typename BufferPool::ConstBuffer CopyBuffer(const typename BufferPool::ConstBuffer& buffer, BufferPool& pool)
+    {
+        auto result = pool.TakeBuffer();
+
+        if (buffer)
+        {
+            const auto& memory = pool.GetMemory();
+
+            for (const auto& blob : buffer)
+            {
+                if (blob.size() == 0)
+                {
+                    continue;
+                }
+
+                if (blob.IsReference())
+                {
+                    throw std::invalid_argument{ "Blob references must be resolved before copying." };
+                }
+
+                if (memory->Contains(blob.data()))
+                {
+                    result->push_back(blob);
+                }
+                else
+                {
+                    auto copy = pool.TakeBlob();
+                    copy->resize(blob.size(), boost::container::default_init);
+                    std::memcpy(copy->data(), blob.data(), blob.size());
+
+                    result->push_back(std::move(copy));
+                }
+            }
+        }
+
+        return std::move(result);
+    }
+
 
     namespace detail
     {
@@ -349,6 +620,14 @@ namespace Bond
             using IPC::detail::LockFree::Queue<T, SharedMemory::Allocator<char>>::Queue;
         };
 
+        // Hands out the most recently released item first, which is still warm in the cache.
+        template <typename T>
+        class LifoBufferPoolQueue : public LockFreeStack<T, SharedMemory::Allocator<char>>
+        {
+        public:
+            using LockFreeStack<T, SharedMemory::Allocator<char>>::LockFreeStack;
+        };
+
         template <typename BufferPool>
         class ConstBuffer : public BufferPool::ConstBuffer
         {
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <memory>
 
 
@@ -28,9 +29,24 @@ namespace Bond
 
         const std::shared_ptr<SharedMemory>& GetMemory() const;
 
+        // Lets blobs of at least minSize residing in the peer memory be written as references,
+        // which the peer resolves against its own memory instead of receiving a copy. References are
+        // only made once the peer advertised resolving them, see detail::ProtocolNegotiation.
+        void EnablePeerReferences(std::shared_ptr<SharedMemory> peerMemory, std::size_t minSize = 4096);
+
+        // Returns an empty blob when references are disabled or the blob is not in the peer memory.
+        ConstBlob MakeReference(const ConstBlob& blob);
+
+        // Returns an equivalent buffer when the given one contains references, otherwise an empty buffer.
+        // Referenced blobs are linked from this pool's memory and the others from the given buffer, so no
+        // payload is copied. The result mixes both memories and is only valid in this process, it must be
+        // passed through CopyBuffer before being sent.
+        ConstBuffer ResolveReferences(const ConstBuffer& buffer);
+
     private:
         struct Data;
         class ItemBase;
+        struct Pin;
 
         class Impl;
 
@@ -43,6 +59,9 @@ namespace Bond
         template <typename T>
         class DefaultBufferPoolQueue;
 
+        template <typename T>
+        class LifoBufferPoolQueue;
+
         template <typename BufferPool>
         class ConstBuffer;
 
@@ -51,6 +70,9 @@ namespace Bond
 
     using DefaultBufferPool = BufferPool<detail::DefaultBufferPoolQueue>;
 
+    // Reuses the most recently released blobs first, see BufferPoolTests/QueueBenchmark.
+    using LifoBufferPool = BufferPool<detail::LifoBufferPoolQueue>;
+
     using DefaultConstBuffer = detail::ConstBuffer<DefaultBufferPool>;
 
 } // Bond
@@ -0,0 +1,669 @@
+#pragma once
+
+#include "OutputBuffer.h"
+#include "BlobCast.h"
+#include "BufferPool.h"
+#include "Serializer.h"
+#include <bond/core/bond.h>
+#include <bond/stream/input_buffer.h>
+#include <boost/smart_ptr/make_shared_array.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+
+namespace IPC
+{
+namespace Bond
+{
+    namespace detail
+    {
+    namespace ChunkedStream
+    {
+        // Leading blob of every chunk packet.
+        struct Header
+        {
+            std::uint64_t m_streamId;
+            std::uint32_t m_sequence;
+            std::uint32_t m_flags;
+        };
+
+        constexpr std::uint32_t LastChunk = 1;
+
+        inline std::uint64_t MakeStreamId()
+        {
+            static std::atomic<std::uint64_t> s_nextId{ 1 };
+            return s_nextId++;
+        }
+
+        template <typename ConstBuffer>
+        Header ReadHeader(const ConstBuffer& packet)
+        {
+            Header header;
+
+            if (!packet || packet.begin() == packet.end() || packet.begin()->size() != sizeof(header))
+            {
+                throw std::invalid_argument{ "Invalid chunk packet." };
+            }
+
+            std::memcpy(&header, packet.begin()->data(), sizeof(header));
+
+            return header;
+        }
+
+    } // ChunkedStream
+    } // detail
+
+
+    // Output buffer which hands the message over to sink in chunk packets of about chunkSize bytes while
+    // it is being written, so messages may be larger than the shared memory. At most window bytes written
+    // by this buffer are kept alive by the receiver at any time, writes block until it releases earlier
+    // chunks and throw once timeout expires. Finish must be called after the last write.
+    // The first chunk is emitted as soon as a single blob is filled and the following ones double in size
+    // up to chunkSize, so the receiver starts decoding while the rest of the message is still being encoded.
+    template <typename BufferPool>
+    class ChunkedOutputBuffer : public OutputBuffer<BufferPool>
+    {
+        using Base = OutputBuffer<BufferPool>;
+
+    public:
+        using Sink = std::function<void(typename BufferPool::ConstBuffer&&)>;
+
+        ChunkedOutputBuffer(
+            std::shared_ptr<BufferPool> pool,
+            Sink sink,
+            std::size_t chunkSize = 1024 * 1024,
+            std::size_t window = 4 * 1024 * 1024,
+            std::chrono::milliseconds timeout = std::chrono::seconds{ 30 })
+            : Base{ std::move(pool), (std::min)(chunkSize, std::size_t{ 4096 }) },
+              m_sink{ std::move(sink) },
+              m_chunkSize{ (std::max)(chunkSize, std::size_t{ 1 }) },
+              m_limit{ (std::min)(m_chunkSize, std::size_t{ 4096 }) },
+              m_window{ (std::max)(window, chunkSize) },
+              m_timeout{ timeout },
+              m_streamId{ detail::ChunkedStream::MakeStreamId() }
+        {}
+
+        using Base::Write;
+
+        template <typename T>
+        void Write(const T& value)
+        {
+            Base::Write(value);
+            Check();
+        }
+
+        // Large values are split over chunks.
+        void Write(const void* value, std::uint32_t size)
+        {
+            while (size != 0)
+            {
+                auto used = this->GetSize();
+                auto n = static_cast<std::uint32_t>((std::min<std::size_t>)(size, used < m_limit ? m_limit - used : 0));
+
+                if (n == 0)
+                {
+                    Emit(false);
+                    continue;
+                }
+
+                Base::Write(value, n);
+
+                value = static_cast<const char*>(value) + n;
+                size -= n;
+
+                Check();
+            }
+        }
+
+        void Write(const bond::blob& blob)
+        {
+            WriteBlob(blob);
+        }
+
+        void Write(const typename BufferPool::ConstBuffer& buffer)
+        {
+            if (buffer)
+            {
+                for (const auto& blob : buffer)
+                {
+                    WriteBlob(blob);
+                }
+            }
+        }
+
+        void Write(const typename BufferPool::ConstBuffer::Range& range)
+        {
+            Base::ForEachBlob(range, [this](const auto& blob) { WriteBlob(blob); });
+        }
+
+        template <typename T>
+        void WriteVariableUnsigned(T value)
+        {
+            Base::WriteVariableUnsigned(value);
+            Check();
+        }
+
+        void Finish()
+        {
+            if (!m_isFinished)
+            {
+                Emit(true);
+                m_isFinished = true;
+            }
+        }
+
+        std::uint64_t GetStreamId() const
+        {
+            return m_streamId;
+        }
+
+    private:
+        // Blobs which cannot be shared are copied and split over chunks like other large values.
+        template <typename Blob>
+        void WriteBlob(const Blob& blob)
+        {
+            if (this->Share(blob))
+            {
+                Check();
+            }
+            else
+            {
+                Write(blob.data(), static_cast<std::uint32_t>(blob.size()));
+            }
+        }
+
+        void Check()
+        {
+            if (this->GetSize() >= m_limit)
+            {
+                Emit(false);
+            }
+        }
+
+        void Emit(bool isLast)
+        {
+            if (m_isFinished)
+            {
+                throw std::logic_error{ "Stream is already finished." };
+            }
+
+            // Data stays in the buffer if the receiver does not catch up in time.
+            Reserve(this->GetSize());
+
+            auto payload = this->TakeChunk();
+
+            m_limit = (std::min)(m_limit * 2, m_chunkSize);
+
+            auto& pool = *this->GetBufferPool();
+
+            auto header = pool.TakeBlob();
+            header->resize(sizeof(detail::ChunkedStream::Header), boost::container::default_init);
+
+            const detail::ChunkedStream::Header value{ m_streamId, m_sequence++, isLast ? detail::ChunkedStream::LastChunk : 0 };
+            std::memcpy(header->data(), &value, sizeof(value));
+
+            auto packet = pool.TakeBuffer();
+            packet->push_back(std::move(header));
+
+            if (payload)
+            {
+                for (const auto& blob : payload)
+                {
+                    // Only blobs written by this buffer count against the window, others may be held elsewhere.
+                    if (blob.IsUnique())
+                    {
+                        m_pending.push_back(blob);
+                        m_pendingSize += blob.size();
+                    }
+
+                    packet->push_back(blob);
+                }
+            }
+
+            payload = {};
+
+            m_sink(std::move(packet));
+        }
+
+        void Reserve(std::size_t size)
+        {
+            auto deadline = std::chrono::steady_clock::now() + m_timeout;
+            auto delay = std::chrono::microseconds{ 10 };
+
+            while (true)
+            {
+                m_pending.erase(
+                    std::remove_if(
+                        m_pending.begin(),
+                        m_pending.end(),
+                        [this](const auto& blob)
+                        {
+                            if (blob.IsUnique())
+                            {
+                                m_pendingSize -= blob.size();
+                                return true;
+                            }
+
+                            return false;
+                        }),
+                    m_pending.end());
+
+                if (m_pendingSize + size <= m_window || m_pending.empty())
+                {
+                    break;
+                }
+
+                if (std::chrono::steady_clock::now() >= deadline)
+                {
+                    throw std::runtime_error{ "Timed out waiting for the receiver to consume chunks." };
+                }
+
+                // Blobs are released by the receiver in another process, there is nothing to wait on.
+                std::this_thread::sleep_for(delay);
+                delay = (std::min)(delay * 2, std::chrono::microseconds{ 1000 });
+            }
+        }
+
+        Sink m_sink;
+        const std::size_t m_chunkSize;
+        std::size_t m_limit;    // Size of the next chunk.
+        const std::size_t m_window;
+        const std::chrono::milliseconds m_timeout;
+        const std::uint64_t m_streamId;
+        std::uint32_t m_sequence{ 0 };
+        bool m_isFinished{ false };
+        std::vector<typename BufferPool::ConstBlob> m_pending;
+        std::size_t m_pendingSize{ 0 };
+    };
+
+
+    // Chunk packets of a single stream in arrival order.
+    template <typename ConstBuffer>
+    class ChunkQueue
+    {
+    public:
+        void Push(ConstBuffer&& packet)
+        {
+            {
+                std::lock_guard<std::mutex> guard{ m_lock };
+                m_packets.push_back(std::move(packet));
+            }
+
+            m_condition.notify_one();
+        }
+
+        // Wakes up the reader with an error, e.g. when the connection is closed.
+        void Close()
+        {
+            {
+                std::lock_guard<std::mutex> guard{ m_lock };
+                m_isClosed = true;
+            }
+
+            m_condition.notify_all();
+        }
+
+        ConstBuffer Pop(std::chrono::milliseconds timeout)
+        {
+            std::unique_lock<std::mutex> guard{ m_lock };
+
+            if (!m_condition.wait_for(guard, timeout, [this] { return !m_packets.empty() || m_isClosed; }))
+            {
+                throw std::runtime_error{ "Timed out waiting for a chunk." };
+            }
+
+            if (m_packets.empty())
+            {
+                throw std::runtime_error{ "Stream is closed." };
+            }
+
+            auto packet = std::move(m_packets.front());
+            m_packets.pop_front();
+
+            return packet;
+        }
+
+    private:
+        std::mutex m_lock;
+        std::condition_variable m_condition;
+        std::deque<ConstBuffer> m_packets;
+        bool m_isClosed{ false };
+    };
+
+
+    // Routes incoming chunk packets to the queues of their streams. Meant to be the handler of a one-way
+    // Server, handler is invoked with the queue of every new stream and must read it on another thread.
+    template <typename ConstBuffer>
+    class ChunkedStreamReceiver
+    {
+    public:
+        using Handler = std::function<void(std::shared_ptr<ChunkQueue<ConstBuffer>>)>;
+
+        explicit ChunkedStreamReceiver(Handler handler)
+            : m_state{ std::make_shared<State>(std::move(handler)) }
+        {}
+
+        void operator()(ConstBuffer&& packet) const
+        {
+            auto header = detail::ChunkedStream::ReadHeader(packet);
+
+            std::shared_ptr<ChunkQueue<ConstBuffer>> queue;
+            bool isNew = false;
+            {
+                std::lock_guard<std::mutex> guard{ m_state->m_lock };
+
+                auto& entry = m_state->m_streams[header.m_streamId];
+
+                if (!entry)
+                {
+                    entry = std::make_shared<ChunkQueue<ConstBuffer>>();
+                    isNew = true;
+                }
+
+                queue = (header.m_flags & detail::ChunkedStream::LastChunk) != 0 ? std::move(entry) : entry;
+
+                if (!entry)
+                {
+                    m_state->m_streams.erase(header.m_streamId);
+                }
+            }
+
+            queue->Push(std::move(packet));
+
+            if (isNew)
+            {
+                m_state->m_handler(std::move(queue));
+            }
+        }
+
+        // Fails the readers of all incomplete streams.
+        void Close() const
+        {
+            std::unordered_map<std::uint64_t, std::shared_ptr<ChunkQueue<ConstBuffer>>> streams;
+            {
+                std::lock_guard<std::mutex> guard{ m_state->m_lock };
+                streams.swap(m_state->m_streams);
+            }
+
+            for (auto& entry : streams)
+            {
+                entry.second->Close();
+            }
+        }
+
+    private:
+        struct State
+        {
+            explicit State(Handler handler)
+                : m_handler{ std::move(handler) }
+            {}
+
+            Handler m_handler;
+            std::mutex m_lock;
+            std::unordered_map<std::uint64_t, std::shared_ptr<ChunkQueue<ConstBuffer>>> m_streams;
+        };
+
+        std::shared_ptr<State> m_state;
+    };
+
+
+    // Input buffer reading a message from chunk packets as they arrive. Each chunk is released as soon as
+    // the read cursor moves past it. Copies share the cursor, so readers can be passed around cheaply,
+    // but positions cannot be captured (no bonded<T> fields).
+    template <typename ConstBuffer>
+    class ChunkedInputBuffer
+    {
+    public:
+        ChunkedInputBuffer(
+            std::shared_ptr<ChunkQueue<ConstBuffer>> queue,
+            std::shared_ptr<SharedMemory> memory,
+            std::chrono::milliseconds timeout = std::chrono::seconds{ 30 })
+            : m_state{ std::make_shared<State>(std::move(queue), std::move(memory), timeout) }
+        {}
+
+        template <typename T>
+        void Read(T& value)
+        {
+            // Primitives never span blobs.
+            std::memcpy(&value, Consume(sizeof(T)), sizeof(T));
+        }
+
+        void Read(void* buffer, std::uint32_t size)
+        {
+            while (size != 0)
+            {
+                auto n = (std::min)(size, static_cast<std::uint32_t>(Fetch()));
+
+                std::memcpy(buffer, Consume(n), n);
+
+                buffer = static_cast<char*>(buffer) + n;
+                size -= n;
+            }
+        }
+
+        void Read(bond::blob& bondBlob, std::uint32_t size)
+        {
+            if (size != 0 && Fetch() >= size)
+            {
+                auto& state = *m_state;
+                const auto& blob = *state.m_blob;
+
+                auto offset = static_cast<std::uint32_t>(Consume(size) - blob.data());
+                bondBlob.assign(BlobCast(blob, state.m_memory), offset, size);
+            }
+            else
+            {
+                // Spans over chunks, has to be assembled.
+                auto data = boost::make_shared<char[]>(size);
+                Read(data.get(), size);
+                bondBlob.assign(boost::shared_ptr<const char[]>{ std::move(data) }, size);
+            }
+        }
+
+        template <typename T>
+        void ReadVariableUnsigned(T& value)
+        {
+            if (Fetch() > sizeof(T) * 8 / 7)
+            {
+                auto& state = *m_state;
+                auto ptr = state.m_ptr;
+                bond::input_buffer::VariableUnsignedUnchecked<T, 0>::Read(ptr, value);
+                state.m_ptr = ptr;
+            }
+            else
+            {
+                bond::GenericReadVariableUnsigned(*this, value);
+            }
+        }
+
+        void Skip(std::uint32_t size)
+        {
+            while (size != 0)
+            {
+                auto n = (std::min)(size, static_cast<std::uint32_t>(Fetch()));
+                Consume(n);
+                size -= n;
+            }
+        }
+
+        bool IsEof() const
+        {
+            return Fetch() == 0;
+        }
+
+    private:
+        using BlobIterator = decltype(std::declval<ConstBuffer>().begin());
+
+        struct State
+        {
+            State(std::shared_ptr<ChunkQueue<ConstBuffer>> queue, std::shared_ptr<SharedMemory> memory, std::chrono::milliseconds timeout)
+                : m_queue{ std::move(queue) },
+                  m_memory{ std::move(memory) },
+                  m_timeout{ timeout }
+            {}
+
+            std::shared_ptr<ChunkQueue<ConstBuffer>> m_queue;
+            std::shared_ptr<SharedMemory> m_memory; // Must be declared before m_packet.
+            std::chrono::milliseconds m_timeout;
+            ConstBuffer m_packet;
+            BlobIterator m_blob{};
+            BlobIterator m_blobEnd{};
+            const char* m_ptr{ nullptr };
+            const char* m_ptrEnd{ nullptr };
+            std::uint64_t m_streamId{ 0 };
+            std::uint32_t m_sequence{ 0 };
+            bool m_isLast{ false };
+        };
+
+        // Returns the number of contiguous bytes available, waits for the next chunk when needed.
+        // Zero is returned only at the end of the stream.
+        std::size_t Fetch() const
+        {
+            auto& state = *m_state;
+
+            while (state.m_ptr == state.m_ptrEnd)
+            {
+                if (state.m_packet && state.m_blob != state.m_blobEnd && ++state.m_blob != state.m_blobEnd)
+                {
+                    state.m_ptr = state.m_blob->data();
+                    state.m_ptrEnd = state.m_ptr + state.m_blob->size();
+                    continue;
+                }
+
+                if (state.m_isLast)
+                {
+                    return 0;
+                }
+
+                // Releases the chunk behind the cursor before waiting for the next one.
+                state.m_packet = {};
+                state.m_packet = state.m_queue->Pop(state.m_timeout);
+
+                auto header = detail::ChunkedStream::ReadHeader(state.m_packet);
+
+                if (state.m_sequence == 0)
+                {
+                    state.m_streamId = header.m_streamId;
+                }
+
+                if (header.m_streamId != state.m_streamId || header.m_sequence != state.m_sequence)
+                {
+                    throw std::runtime_error{ "Unexpected chunk." };
+                }
+
+                ++state.m_sequence;
+                state.m_isLast = (header.m_flags & detail::ChunkedStream::LastChunk) != 0;
+
+                state.m_blob = state.m_packet.begin();
+                state.m_blobEnd = state.m_packet.end();
+                state.m_ptr = state.m_ptrEnd = nullptr;     // Skips the header.
+            }
+
+            return state.m_ptrEnd - state.m_ptr;
+        }
+
+        const char* Consume(std::size_t size) const
+        {
+            if (Fetch() < size)
+            {
+                throw std::out_of_range{ "Out of buffer range." };
+            }
+
+            auto& state = *m_state;
+
+            auto ptr = state.m_ptr;
+            state.m_ptr += size;
+
+            return ptr;
+        }
+
+        std::shared_ptr<State> m_state;
+    };
+
+
+    // Serializes value into chunk packets passed to sink, see ChunkedOutputBuffer.
+    template <template <typename> typename Writer, typename Protocols = DefaultProtocols, typename BufferPool, typename T>
+    std::uint64_t StreamSerialize(
+        std::shared_ptr<BufferPool> pool,
+        const T& value,
+        typename ChunkedOutputBuffer<BufferPool>::Sink sink,
+        std::size_t chunkSize = 1024 * 1024,
+        std::size_t window = 4 * 1024 * 1024)
+    {
+        ChunkedOutputBuffer<BufferPool> output{ std::move(pool), std::move(sink), chunkSize, window };
+        Writer<decltype(output)> writer{ output };
+        bond::Serialize<Protocols>(value, writer);
+        output.Finish();
+
+        return output.GetStreamId();
+    }
+
+    template <template <typename> typename Reader, typename ConstBuffer, typename T>
+    void StreamDeserialize(ChunkedInputBuffer<ConstBuffer> input, T& value)
+    {
+        Reader<ChunkedInputBuffer<ConstBuffer>> reader{ std::move(input) };
+        bond::Deserialize<bond::Protocols<Reader<ChunkedInputBuffer<ConstBuffer>>>>(reader, value);
+    }
+
+    // Protocol is chosen at run time, only binary protocols can be decoded while chunks arrive.
+    template <typename Protocols = DefaultProtocols, typename BufferPool, typename T>
+    std::uint64_t StreamSerialize(
+        bond::ProtocolType protocol,
+        std::shared_ptr<BufferPool> pool,
+        const T& value,
+        typename ChunkedOutputBuffer<BufferPool>::Sink sink,
+        std::size_t chunkSize = 1024 * 1024,
+        std::size_t window = 4 * 1024 * 1024)
+    {
+        switch (protocol)
+        {
+        case bond::ProtocolType::COMPACT_PROTOCOL:
+            return StreamSerialize<bond::CompactBinaryWriter, Protocols>(std::move(pool), value, std::move(sink), chunkSize, window);
+
+        case bond::ProtocolType::FAST_PROTOCOL:
+            return StreamSerialize<bond::FastBinaryWriter, Protocols>(std::move(pool), value, std::move(sink), chunkSize, window);
+
+        case bond::ProtocolType::SIMPLE_PROTOCOL:
+            return StreamSerialize<bond::SimpleBinaryWriter, Protocols>(std::move(pool), value, std::move(sink), chunkSize, window);
+
+        default:
+            throw std::invalid_argument{ "Unsupported stream protocol." };
+        }
+    }
+
+    template <typename ConstBuffer, typename T>
+    void StreamDeserialize(bond::ProtocolType protocol, ChunkedInputBuffer<ConstBuffer> input, T& value)
+    {
+        switch (protocol)
+        {
+        case bond::ProtocolType::COMPACT_PROTOCOL:
+            StreamDeserialize<bond::CompactBinaryReader>(std::move(input), value);
+            break;
+
+        case bond::ProtocolType::FAST_PROTOCOL:
+            StreamDeserialize<bond::FastBinaryReader>(std::move(input), value);
+            break;
+
+        case bond::ProtocolType::SIMPLE_PROTOCOL:
+            StreamDeserialize<bond::SimpleBinaryReader>(std::move(input), value);
+            break;
+
+        default:
+            throw std::invalid_argument{ "Unsupported stream protocol." };
+        }
+    }
+
+} // Bond
+} // IPC
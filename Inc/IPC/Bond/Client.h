@@ -1,9 +1,14 @@
 #pragma once
 
+#include "detail/BlobHolder.h"
 #include "detail/ComponentBase.h"
+#include "detail/HandlerTraits.h"
+#include "detail/ProtocolNegotiation.h"
 #include <IPC/Client.h>
 #include "DefaultTraits.h"
+#include "ObjectPool.h"
 #include <bond/core/bond_const_enum.h>
+#include <stdexcept>
 
 
 namespace IPC
@@ -22,46 +27,166 @@ namespace Bond
             typename Base::Serializer serializer,
             std::unique_ptr<typename Base::Connection> connection,
             CloseHandler&& closeHandler,
-            typename Base::TransactionManager transactionManager = {})
-            : Base{ std::move(pools), std::move(serializer), std::move(connection), std::forward<CloseHandler>(closeHandler), std::move(transactionManager) }
+            typename Base::TransactionManager transactionManager = {},
+            typename Traits::DeserializationScheduler scheduler = {},
+            typename Traits::RequestCoalescer coalescer = {},
+            typename Traits::template ObjectPool<Response> objects = {})
+            : Base{ std::move(pools), std::move(serializer), std::move(connection), std::forward<CloseHandler>(closeHandler), std::move(transactionManager) },
+              m_dispatcher{ scheduler.MakeDispatcher() },
+              m_coalescer{ std::move(coalescer) },
+              m_objects{ std::move(objects) }
         {}
 
         template <typename Callback, typename... TransactionArgs, typename U = Response, std::enable_if_t<!std::is_void<U>::value>* = nullptr,
             decltype(std::declval<Callback>()(std::declval<std::future<U>>()))* = nullptr>
         void operator()(const Request& request, Callback&& callback, TransactionArgs&&... transactionArgs)
         {
-            Base::operator()(
+            Send(
                 this->Serialize(request),
-                [serializer = static_cast<typename Base::Serializer&>(*this), callback = std::forward<Callback>(callback)](typename Traits::BufferPool::ConstBuffer&& buffer) mutable
+                Dispatch([serializer = static_cast<typename Base::Serializer&>(*this), callback = std::forward<Callback>(callback)](typename Traits::BufferPool::ConstBuffer&& buffer) mutable
                 {
                     callback(serializer.template Deserialize<Response>(std::move(buffer)));
+                }),
+                std::forward<TransactionArgs>(transactionArgs)...);
+        }
+
+        template <typename Callback, typename... TransactionArgs, typename U = Response, std::enable_if_t<!std::is_void<U>::value>* = nullptr,
+            std::enable_if_t<detail::IsValueCallback<std::decay_t<Callback>, U>::value>* = nullptr>
+        void operator()(const Request& request, Callback&& callback, TransactionArgs&&... transactionArgs)
+        {
+            Send(
+                this->Serialize(request),
+                Dispatch([serializer = static_cast<typename Base::Serializer&>(*this), objects = m_objects, callback = std::forward<Callback>(callback)](
+                    typename Traits::BufferPool::ConstBuffer&& buffer) mutable
+                {
+                    // Callback must accept both Response&& and std::exception_ptr, the response goes back to the pool once it returns.
+                    detail::DeserializeAndInvoke<Response>(serializer, objects, std::move(buffer), callback);
+                }),
+                std::forward<TransactionArgs>(transactionArgs)...);
+        }
+
+        // Deserializes into the caller-owned response which must stay alive until the callback is invoked.
+        // Callback receives a null std::exception_ptr on success.
+        template <typename Callback, typename... TransactionArgs, typename U = Response,
+            decltype(std::declval<Callback>()(std::declval<std::exception_ptr>()))* = nullptr>
+        void operator()(const Request& request, std::enable_if_t<!std::is_void<U>::value, U>& response, Callback&& callback, TransactionArgs&&... transactionArgs)
+        {
+            Send(
+                this->Serialize(request),
+                Dispatch([serializer = static_cast<typename Base::Serializer&>(*this), &response, callback = std::forward<Callback>(callback)](
+                    typename Traits::BufferPool::ConstBuffer&& buffer) mutable
+                {
+                    std::exception_ptr error;
+
+                    try
+                    {
+                        detail::ResetObject(response, detail::GetDefault<Response>());
+                        serializer.Deserialize(std::move(buffer), response);
+                    }
+                    catch (...)
+                    {
+                        error = std::current_exception();
+                    }
+
+                    callback(error);
+                }),
+                std::forward<TransactionArgs>(transactionArgs)...);
+        }
+
+        // The response given to the callback may link blobs of both memories once peer references are resolved,
+        // it must be passed through CopyBuffer before being sent on. Forwarded buffers keep the marshaling header,
+        // so a client must be used for forwarding before it sends anything else.
+        template <typename Callback, typename... TransactionArgs, typename U = Response, std::enable_if_t<!std::is_void<U>::value>* = nullptr>
+        void Forward(const typename Traits::BufferPool::ConstBuffer& request, Callback&& callback, TransactionArgs&&... transactionArgs)
+        {
+            DisableHeaderless();
+
+            Base::operator()(
+                CopyBuffer(request, *this->GetOutputPool()),
+                [pool = this->GetOutputPool(), callback = std::forward<Callback>(callback)](typename Traits::BufferPool::ConstBuffer&& response) mutable
+                {
+                    auto resolved = pool->ResolveReferences(response);
+                    callback(resolved ? std::move(resolved) : std::move(response));
                 },
                 std::forward<TransactionArgs>(transactionArgs)...);
         }
 
+        template <typename U = Response, std::enable_if_t<std::is_void<U>::value>* = nullptr>
+        void Forward(const typename Traits::BufferPool::ConstBuffer& request)
+        {
+            DisableHeaderless();
+
+            Base::operator()(CopyBuffer(request, *this->GetOutputPool()));
+        }
+
         template <typename U = Response, std::enable_if_t<std::is_void<U>::value>* = nullptr>
         void operator()(const Request& request)
         {
             Base::operator()(this->Serialize(request));
         }
 
+        // The shared state of the returned future is recycled, so no heap allocation is made for it after warm-up.
         template <typename... TransactionArgs, typename U = Response, std::enable_if_t<!std::is_void<U>::value>* = nullptr>
         std::future<Response> operator()(const Request& request, TransactionArgs&&... transactionArgs)
         {
-            std::packaged_task<Response(typename Traits::BufferPool::ConstBuffer&&)> callback{
-                [serializer = static_cast<typename Base::Serializer&>(*this)](typename Traits::BufferPool::ConstBuffer&& buffer) mutable
+            std::promise<Response> promise{ std::allocator_arg, detail::PooledAllocator<Response>{} };
+            auto result = promise.get_future();
+
+            Send(
+                this->Serialize(request),
+                Dispatch([serializer = static_cast<typename Base::Serializer&>(*this), promise = std::move(promise)](typename Traits::BufferPool::ConstBuffer&& buffer) mutable
                 {
-                    Response response;
-                    serializer.Deserialize(std::move(buffer), response);
-                    return response;
-                } };
+                    try
+                    {
+                        Response response;
+                        serializer.Deserialize(std::move(buffer), response);
+                        promise.set_value(std::move(response));
+                    }
+                    catch (...)
+                    {
+                        promise.set_exception(std::current_exception());
+                    }
+                }),
+                std::forward<TransactionArgs>(transactionArgs)...);
+
+            return result;
+        }
 
-            auto result = callback.get_future();
+    private:
+        using Dispatcher = decltype(std::declval<const typename Traits::DeserializationScheduler&>().MakeDispatcher());
 
-            Base::operator()(this->Serialize(request), std::move(callback), std::forward<TransactionArgs>(transactionArgs)...);
+        template <typename Callback, typename... TransactionArgs>
+        void Send(typename Traits::BufferPool::ConstBuffer&& request, Callback&& callback, TransactionArgs&&... transactionArgs)
+        {
+            m_coalescer(
+                std::move(request),
+                std::forward<Callback>(callback),
+                [&](typename Traits::BufferPool::ConstBuffer&& request, auto&& callback)
+                {
+                    Base::operator()(std::move(request), std::forward<decltype(callback)>(callback), std::forward<TransactionArgs>(transactionArgs)...);
+                });
+        }
 
-            return result;
+        void DisableHeaderless()
+        {
+            if (!detail::DisableHeaderless(static_cast<typename Base::Serializer&>(*this)))
+            {
+                throw std::logic_error{ "Cannot forward over a connection exchanging headerless messages." };
+            }
         }
+
+        template <typename Function>
+        auto Dispatch(Function&& func)
+        {
+            return [dispatcher = m_dispatcher, func = std::forward<Function>(func)](typename Traits::BufferPool::ConstBuffer&& buffer) mutable
+            {
+                dispatcher(std::move(buffer), std::move(func));
+            };
+        }
+
+        Dispatcher m_dispatcher;
+        typename Traits::RequestCoalescer m_coalescer;
+        typename Traits::template ObjectPool<Response> m_objects;
     };
 
 
@@ -72,13 +197,24 @@ namespace Bond
         bond::ProtocolType protocol = bond::ProtocolType::COMPACT_PROTOCOL,
         bool marshal = true,
         std::size_t minBlobSize = 0,
-        typename Client<Request, Response, Traits>::TransactionManager transactionManager = {})
+        typename Client<Request, Response, Traits>::TransactionManager transactionManager = {},
+        typename Traits::DeserializationScheduler scheduler = {},
+        typename Traits::RequestCoalescer coalescer = {},
+        typename Traits::template ObjectPool<Response> objects = {})
     {
-        auto pools = detail::MakeBufferPoolHolder<typename Traits::BufferPool>(*connection);
+        auto pools = detail::MakeBufferPoolHolder<typename Traits::BufferPool>(*connection, Traits::EnablePeerReferences);
         typename Traits::Serializer serializer{ protocol, marshal, pools.GetOutputPool(), pools.GetInputPool()->GetMemory(), minBlobSize };
+        detail::NegotiateProtocol(serializer);
 
         return std::make_unique<Client<Request, Response, Traits>>(
-            std::move(pools), std::move(serializer), std::move(connection), std::forward<CloseHandler>(closeHandler), std::move(transactionManager));
+            std::move(pools),
+            std::move(serializer),
+            std::move(connection),
+            std::forward<CloseHandler>(closeHandler),
+            std::move(transactionManager),
+            std::move(scheduler),
+            std::move(coalescer),
+            std::move(objects));
     }
 
 } // Bond
@@ -14,6 +14,77 @@ namespace IPC
 {
 namespace Bond
 {
+    namespace detail
+    {
+        template <typename PacketConnector, typename TimeoutFactory, typename ErrorHandler, typename... TransactionArgs>
+        auto ConnectClient(
+            const char* acceptorName,
+            std::shared_ptr<PacketConnector> connector,
+            bool async,
+            bond::ProtocolType protocol,
+            bool marshal,
+            std::size_t minBlobSize,
+            TimeoutFactory&& timeoutFactory,
+            ErrorHandler&& errorHandler,
+            typename PacketConnector::Traits::TransactionManagerFactory transactionManagerFactory,
+            typename PacketConnector::Traits::DeserializationScheduler scheduler,
+            TransactionArgs&&... transactionArgs)
+        {
+            return IPC::detail::Connect(
+                acceptorName,
+                std::move(connector),
+                async,
+                std::forward<TimeoutFactory>(timeoutFactory),
+                std::forward<ErrorHandler>(errorHandler),
+                [protocol, marshal, minBlobSize, transactionManagerFactory = std::move(transactionManagerFactory), scheduler = std::move(scheduler)](auto&& connection, auto&& callback)
+                {
+                    using Client = Client<typename PacketConnector::Request, typename PacketConnector::Response, typename PacketConnector::Traits>;
+
+                    return MakeClient<typename PacketConnector::Request, typename PacketConnector::Response, typename PacketConnector::Traits>(
+                        std::move(connection),
+                        std::forward<decltype(callback)>(callback),
+                        protocol,
+                        marshal,
+                        minBlobSize,
+                        transactionManagerFactory(IPC::detail::Identity<typename Client::TransactionManager>{}),
+                        scheduler);
+                },
+                std::forward<TransactionArgs>(transactionArgs)...);
+        }
+
+        template <typename PacketConnector, typename HandlerFactory, typename TimeoutFactory, typename ErrorHandler, typename... TransactionArgs>
+        auto ConnectServer(
+            const char* acceptorName,
+            std::shared_ptr<PacketConnector> connector,
+            HandlerFactory&& handlerFactory,
+            bool async,
+            bond::ProtocolType protocol,
+            bool marshal,
+            std::size_t minBlobSize,
+            TimeoutFactory&& timeoutFactory,
+            ErrorHandler&& errorHandler,
+            typename PacketConnector::Traits::DeserializationScheduler scheduler,
+            typename PacketConnector::Traits::ResponseCache cache,
+            TransactionArgs&&... transactionArgs)
+        {
+            return IPC::detail::Connect(
+                acceptorName,
+                std::move(connector),
+                async,
+                std::forward<TimeoutFactory>(timeoutFactory),
+                std::forward<ErrorHandler>(errorHandler),
+                [protocol, marshal, minBlobSize, handlerFactory = std::forward<HandlerFactory>(handlerFactory), scheduler = std::move(scheduler), cache = std::move(cache)](
+                    auto&& connection, auto&& callback) mutable
+                {
+                    return MakeServer<typename PacketConnector::Request, typename PacketConnector::Response, typename PacketConnector::Traits>(
+                        std::move(connection), handlerFactory, std::forward<decltype(callback)>(callback), protocol, marshal, minBlobSize, scheduler, cache);
+                },
+                std::forward<TransactionArgs>(transactionArgs)...);
+        }
+
+    } // detail
+
+
     template <
         typename PacketConnector,
         typename TimeoutFactory = typename PacketConnector::Traits::TimeoutFactory,
@@ -31,24 +102,17 @@ namespace Bond
         typename PacketConnector::Traits::TransactionManagerFactory transactionManagerFactory = {},
         TransactionArgs&&... transactionArgs)
     {
-        return IPC::detail::Connect(
+        return detail::ConnectClient(
             acceptorName,
             std::move(connector),
             async,
+            protocol,
+            marshal,
+            minBlobSize,
             std::forward<TimeoutFactory>(timeoutFactory),
             std::forward<ErrorHandler>(errorHandler),
-            [protocol, marshal, minBlobSize, transactionManagerFactory = std::move(transactionManagerFactory)](auto&& connection, auto&& callback)
-            {
-                using Client = Client<typename PacketConnector::Request, typename PacketConnector::Response, typename PacketConnector::Traits>;
-
-                return MakeClient<typename PacketConnector::Request, typename PacketConnector::Response, typename PacketConnector::Traits>(
-                    std::move(connection),
-                    std::forward<decltype(callback)>(callback),
-                    protocol,
-                    marshal,
-                    minBlobSize,
-                    transactionManagerFactory(IPC::detail::Identity<typename Client::TransactionManager>{}));
-            },
+            std::move(transactionManagerFactory),
+            typename PacketConnector::Traits::DeserializationScheduler{},
             std::forward<TransactionArgs>(transactionArgs)...);
     }
 
@@ -70,17 +134,18 @@ namespace Bond
         ErrorHandler&& errorHandler = {},
         TransactionArgs&&... transactionArgs)
     {
-        return IPC::detail::Connect(
+        return detail::ConnectServer(
             acceptorName,
             std::move(connector),
+            std::forward<HandlerFactory>(handlerFactory),
             async,
+            protocol,
+            marshal,
+            minBlobSize,
             std::forward<TimeoutFactory>(timeoutFactory),
             std::forward<ErrorHandler>(errorHandler),
-            [protocol, marshal, minBlobSize, handlerFactory = std::forward<HandlerFactory>(handlerFactory)](auto&& connection, auto&& callback) mutable
-            {
-                return MakeServer<typename PacketConnector::Request, typename PacketConnector::Response, typename PacketConnector::Traits>(
-                    std::move(connection), handlerFactory, std::forward<decltype(callback)>(callback), protocol, marshal, minBlobSize);
-            },
+            typename PacketConnector::Traits::DeserializationScheduler{},
+            typename PacketConnector::Traits::ResponseCache{},
             std::forward<TransactionArgs>(transactionArgs)...);
     }
 
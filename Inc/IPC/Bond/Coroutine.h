@@ -0,0 +1,494 @@
+#pragma once
+
+// Requires C++20 coroutines, the header is empty otherwise.
+#if defined(__cpp_impl_coroutine)
+
+#include "detail/HandlerTraits.h"
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <future>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#define IPC_BOND_HAS_COROUTINES 1
+
+
+namespace IPC
+{
+namespace Bond
+{
+    namespace detail
+    {
+        namespace Coroutine
+        {
+            template <typename T>
+            class Promise;
+
+        } // Coroutine
+    } // detail
+
+
+    // Lazily started coroutine producing T. It runs once awaited and resumes the awaiting coroutine
+    // directly on the thread it completes on.
+    template <typename T = void>
+    class Task
+    {
+    public:
+        using promise_type = detail::Coroutine::Promise<T>;
+
+        Task(Task&& other) noexcept
+            : m_handle{ std::exchange(other.m_handle, nullptr) }
+        {}
+
+        Task& operator=(Task&& other) = delete;
+
+        ~Task()
+        {
+            if (m_handle)
+            {
+                m_handle.destroy();
+            }
+        }
+
+        auto operator co_await() && noexcept
+        {
+            struct Awaiter
+            {
+                bool await_ready() const noexcept
+                {
+                    return false;
+                }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) const noexcept
+                {
+                    m_handle.promise().SetContinuation(continuation);
+                    return m_handle;
+                }
+
+                T await_resume() const
+                {
+                    return m_handle.promise().GetResult();
+                }
+
+                std::coroutine_handle<promise_type> m_handle;
+            };
+
+            return Awaiter{ m_handle };
+        }
+
+    private:
+        friend promise_type;
+
+        explicit Task(std::coroutine_handle<promise_type> handle) noexcept
+            : m_handle{ handle }
+        {}
+
+        std::coroutine_handle<promise_type> m_handle;
+    };
+
+
+    namespace detail
+    {
+        namespace Coroutine
+        {
+            // Resumes the awaiting coroutine by symmetric transfer, so chains of tasks do not grow the stack.
+            struct FinalAwaiter
+            {
+                bool await_ready() const noexcept
+                {
+                    return false;
+                }
+
+                template <typename Promise>
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) const noexcept
+                {
+                    if (auto continuation = handle.promise().GetContinuation())
+                    {
+                        return continuation;
+                    }
+
+                    return std::noop_coroutine();
+                }
+
+                void await_resume() const noexcept
+                {}
+            };
+
+
+            class PromiseBase
+            {
+            public:
+                std::suspend_always initial_suspend() const noexcept
+                {
+                    return {};
+                }
+
+                FinalAwaiter final_suspend() const noexcept
+                {
+                    return {};
+                }
+
+                void unhandled_exception() noexcept
+                {
+                    m_error = std::current_exception();
+                }
+
+                void SetContinuation(std::coroutine_handle<> continuation) noexcept
+                {
+                    m_continuation = continuation;
+                }
+
+                std::coroutine_handle<> GetContinuation() const noexcept
+                {
+                    return m_continuation;
+                }
+
+            protected:
+                void RethrowIfFailed() const
+                {
+                    if (m_error)
+                    {
+                        std::rethrow_exception(m_error);
+                    }
+                }
+
+            private:
+                std::coroutine_handle<> m_continuation;
+                std::exception_ptr m_error;
+            };
+
+
+            template <typename T>
+            class Promise : public PromiseBase
+            {
+            public:
+                Task<T> get_return_object() noexcept
+                {
+                    return Task<T>{ std::coroutine_handle<Promise>::from_promise(*this) };
+                }
+
+                void return_value(T value)
+                {
+                    m_value.emplace(std::move(value));
+                }
+
+                T GetResult()
+                {
+                    RethrowIfFailed();
+                    return std::move(*m_value);
+                }
+
+            private:
+                std::optional<T> m_value;
+            };
+
+            template <>
+            class Promise<void> : public PromiseBase
+            {
+            public:
+                Task<void> get_return_object() noexcept
+                {
+                    return Task<void>{ std::coroutine_handle<Promise>::from_promise(*this) };
+                }
+
+                void return_void() const noexcept
+                {}
+
+                void GetResult() const
+                {
+                    RethrowIfFailed();
+                }
+            };
+
+
+            // Eagerly started coroutine which destroys itself on completion.
+            struct Detached
+            {
+                struct promise_type
+                {
+                    Detached get_return_object() const noexcept
+                    {
+                        return {};
+                    }
+
+                    std::suspend_never initial_suspend() const noexcept
+                    {
+                        return {};
+                    }
+
+                    std::suspend_never final_suspend() const noexcept
+                    {
+                        return {};
+                    }
+
+                    void return_void() const noexcept
+                    {}
+
+                    void unhandled_exception() const noexcept
+                    {}  // Failures of callbacks have nowhere to go.
+                };
+            };
+
+            template <typename T, typename Callback>
+            Detached Run(Task<T> task, Callback callback)
+            {
+                std::optional<T> value;
+                std::exception_ptr error;
+
+                try
+                {
+                    value.emplace(co_await std::move(task));
+                }
+                catch (...)
+                {
+                    error = std::current_exception();
+                }
+
+                if (error)
+                {
+                    callback(error);
+                }
+                else
+                {
+                    callback(std::move(*value));
+                }
+            }
+
+            template <typename Callback>
+            Detached Run(Task<void> task, Callback callback)
+            {
+                std::exception_ptr error;
+
+                try
+                {
+                    co_await std::move(task);
+                }
+                catch (...)
+                {
+                    error = std::current_exception();
+                }
+
+                callback(error);
+            }
+
+
+            // Issues the call once the awaiting coroutine is suspended and resumes it from the callback,
+            // i.e. on the thread the DeserializationScheduler of the client runs callbacks on.
+            template <typename Client, typename... TransactionArgs>
+            class ResponseAwaiter
+            {
+                using Request = typename Client::Request;
+                using Response = typename Client::Response;
+
+            public:
+                template <typename... Args>
+                ResponseAwaiter(Client& client, const Request& request, Args&&... transactionArgs)
+                    : m_client{ client },
+                      m_request{ request },
+                      m_transactionArgs{ std::forward<Args>(transactionArgs)... }
+                {}
+
+                ResponseAwaiter(const ResponseAwaiter& other) = delete;
+                ResponseAwaiter& operator=(const ResponseAwaiter& other) = delete;
+
+                bool await_ready() const noexcept
+                {
+                    return false;
+                }
+
+                bool await_suspend(std::coroutine_handle<> handle)
+                {
+                    m_handle = handle;
+
+                    std::apply(
+                        [this](auto&&... transactionArgs)
+                        {
+                            m_client(m_request, Callback{ this }, std::move(transactionArgs)...);
+                        },
+                        m_transactionArgs);
+
+                    // The callback may have run already, in which case the coroutine just continues.
+                    return !m_isCompleted.exchange(true, std::memory_order_acq_rel);
+                }
+
+                Response await_resume()
+                {
+                    if (m_error)
+                    {
+                        std::rethrow_exception(m_error);
+                    }
+
+                    return std::move(*m_response);
+                }
+
+            private:
+                // Move-only, reports a broken promise when dropped by the transport without being invoked.
+                class Callback
+                {
+                public:
+                    explicit Callback(ResponseAwaiter* awaiter) noexcept
+                        : m_awaiter{ awaiter }
+                    {}
+
+                    Callback(Callback&& other) noexcept
+                        : m_awaiter{ std::exchange(other.m_awaiter, nullptr) }
+                    {}
+
+                    Callback& operator=(Callback&& other) = delete;
+
+                    ~Callback()
+                    {
+                        if (m_awaiter)
+                        {
+                            (*this)(std::make_exception_ptr(std::future_error{ std::future_errc::broken_promise }));
+                        }
+                    }
+
+                    void operator()(Response&& response)
+                    {
+                        // Moved out of the pooled object, the coroutine keeps it past the callback.
+                        auto awaiter = std::exchange(m_awaiter, nullptr);
+                        awaiter->m_response.emplace(std::move(response));
+                        awaiter->Complete();
+                    }
+
+                    void operator()(std::exception_ptr error)
+                    {
+                        auto awaiter = std::exchange(m_awaiter, nullptr);
+                        awaiter->m_error = std::move(error);
+                        awaiter->Complete();
+                    }
+
+                private:
+                    ResponseAwaiter* m_awaiter;
+                };
+
+                // Whichever of the callback and await_suspend finishes second resumes the coroutine.
+                void Complete()
+                {
+                    if (m_isCompleted.exchange(true, std::memory_order_acq_rel))
+                    {
+                        m_handle.resume();
+                    }
+                }
+
+                Client& m_client;
+                const Request& m_request;
+                std::tuple<TransactionArgs...> m_transactionArgs;
+                std::coroutine_handle<> m_handle;
+                std::optional<Response> m_response;
+                std::exception_ptr m_error;
+                std::atomic_bool m_isCompleted{ false };
+            };
+
+
+            // Failures which cannot be answered are passed to ErrorHandler, the call is then left without a response.
+            template <typename Handler, typename Request, typename Response, typename ErrorHandler>
+            class TaskHandler
+            {
+            public:
+                template <typename H, typename E>
+                TaskHandler(H&& handler, E&& errorHandler)
+                    : m_handler{ std::forward<H>(handler) },
+                      m_errorHandler{ std::forward<E>(errorHandler) }
+                {}
+
+                // Copied rather than moved, so the pooled request keeps its capacity.
+                template <typename Callback>
+                void operator()(Request&& request, Callback&& callback)
+                {
+                    Run(m_handler(static_cast<const Request&>(request)), ResponseCallback<std::decay_t<Callback>>{ std::forward<Callback>(callback), m_errorHandler });
+                }
+
+                // The request could not be deserialized, there is nothing to invoke the handler with.
+                template <typename Callback>
+                void operator()(std::exception_ptr error, Callback&& /*callback*/)
+                {
+                    m_errorHandler(std::move(error));
+                }
+
+            private:
+                // Outlives the server when the coroutine completes late, so it keeps its own error handler.
+                template <typename Callback>
+                struct ResponseCallback
+                {
+                    void operator()(Response&& response)
+                    {
+                        try
+                        {
+                            m_callback(response);
+                        }
+                        catch (...)
+                        {
+                            m_errorHandler(std::current_exception());
+                        }
+                    }
+
+                    void operator()(std::exception_ptr error)
+                    {
+                        m_errorHandler(std::move(error));
+                    }
+
+                    Callback m_callback;
+                    ErrorHandler m_errorHandler;
+                };
+
+                Handler m_handler;
+                ErrorHandler m_errorHandler;
+            };
+
+        } // Coroutine
+
+
+        // Lets Server accept coroutines of the form Task<Response>(Request). The request must be taken by value,
+        // a reference would dangle once the coroutine suspends. Failures go to a default constructed ErrorHandler.
+        template <typename Handler, typename Request, typename Response, typename ErrorHandler>
+        struct HandlerAdapter<
+            Handler, Request, Response, ErrorHandler, std::enable_if_t<std::is_same<std::invoke_result_t<Handler&, const Request&>, Task<Response>>::value>>
+        {
+            template <typename H>
+            static Coroutine::TaskHandler<Handler, Request, Response, ErrorHandler> Adapt(H&& handler)
+            {
+                return Coroutine::TaskHandler<Handler, Request, Response, ErrorHandler>{ std::forward<H>(handler), ErrorHandler{} };
+            }
+        };
+
+    } // detail
+
+
+    // Runs the task without awaiting it. Callback must accept both T&& and std::exception_ptr,
+    // for Task<void> it only receives a std::exception_ptr which is null on success.
+    template <typename T, typename Callback>
+    void Start(Task<T> task, Callback&& callback)
+    {
+        detail::Coroutine::Run(std::move(task), std::forward<Callback>(callback));
+    }
+
+
+    // Adapts a coroutine handler for Server like it is done implicitly, but reports requests which could not
+    // be deserialized and failed coroutines to errorHandler instead of Traits::ErrorHandler. It is copied into
+    // every call, so it should be cheap to copy.
+    template <typename Request, typename Response, typename Handler, typename ErrorHandler>
+    auto MakeTaskHandler(Handler&& handler, ErrorHandler&& errorHandler)
+    {
+        return detail::Coroutine::TaskHandler<std::decay_t<Handler>, Request, Response, std::decay_t<ErrorHandler>>{
+            std::forward<Handler>(handler), std::forward<ErrorHandler>(errorHandler) };
+    }
+
+
+    // Returns an awaitable for co_await Async(client, request) which blocks no thread and shares no state
+    // with the transport beyond the awaiting coroutine frame. The request must stay alive until resumed.
+    template <typename Client, typename... TransactionArgs>
+    auto Async(Client& client, const typename Client::Request& request, TransactionArgs&&... transactionArgs)
+    {
+        return detail::Coroutine::ResponseAwaiter<Client, std::decay_t<TransactionArgs>...>{
+            client, request, std::forward<TransactionArgs>(transactionArgs)... };
+    }
+
+} // Bond
+} // IPC
+
+#endif
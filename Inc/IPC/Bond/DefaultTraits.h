@@ -3,6 +3,10 @@
 #include <IPC/DefaultTraits.h>
 #include "BufferPool.h"
 #include "Serializer.h"
+#include "DeserializationScheduler.h"
+#include "ResponseCache.h"
+#include "RequestCoalescer.h"
+#include "ObjectPool.h"
 
 
 namespace IPC
@@ -14,6 +18,19 @@ namespace Bond
         using BufferPool = DefaultBufferPool;
 
         using Serializer = DefaultSerializer;
+
+        using DeserializationScheduler = InlineDeserializationScheduler;
+
+        using ResponseCache = NoResponseCache;
+
+        using RequestCoalescer = NoRequestCoalescer;
+
+        template <typename T>
+        using ObjectPool = NoObjectPool<T>;
+
+        // Lets blobs received from the peer be sent back to it by reference instead of a copy, which takes
+        // effect only when both sides of the connection enable it.
+        static constexpr bool EnablePeerReferences = false;
     };
 
 } // Bond
@@ -0,0 +1,179 @@
+#pragma once
+
+#include "ThreadPool.h"
+#include "InplaceFunction.h"
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+
+namespace IPC
+{
+namespace Bond
+{
+    class InlineDeserializationScheduler
+    {
+    public:
+        InlineDeserializationScheduler MakeDispatcher() const
+        {
+            return *this;
+        }
+
+        template <typename Buffer, typename Function>
+        void operator()(Buffer&& buffer, Function&& func) const
+        {
+            std::forward<Function>(func)(std::forward<Buffer>(buffer));
+        }
+    };
+
+
+    class ThresholdDeserializationScheduler
+    {
+    public:
+        class Dispatcher
+        {
+        public:
+            Dispatcher() = default;
+
+            template <typename Buffer, typename Function>
+            void operator()(Buffer&& buffer, Function&& func) const
+            {
+                if (!m_pool || (!m_strand && !IsLarge(buffer)))
+                {
+                    std::forward<Function>(func)(std::forward<Buffer>(buffer));
+                }
+                else if (!m_strand)
+                {
+                    m_pool->Submit(Bind(std::forward<Buffer>(buffer), std::forward<Function>(func)));
+                }
+                else
+                {
+                    Sequence(std::forward<Buffer>(buffer), std::forward<Function>(func));
+                }
+            }
+
+        private:
+            friend ThresholdDeserializationScheduler;
+
+            struct Strand
+            {
+                std::mutex m_lock;
+                std::deque<InplaceFunction<void()>> m_tasks;
+                bool m_isBusy{ false };
+            };
+
+            Dispatcher(std::shared_ptr<ThreadPool> pool, std::size_t threshold, bool preserveOrder)
+                : m_pool{ std::move(pool) },
+                  m_strand{ preserveOrder ? std::make_shared<Strand>() : nullptr },
+                  m_threshold{ threshold }
+            {}
+
+            template <typename Buffer>
+            bool IsLarge(const Buffer& buffer) const
+            {
+                return buffer && buffer.size() >= m_threshold;
+            }
+
+            template <typename Buffer, typename Function>
+            static auto Bind(Buffer&& buffer, Function&& func)
+            {
+                return [buffer = std::forward<Buffer>(buffer), func = std::forward<Function>(func)]() mutable
+                {
+                    func(std::move(buffer));
+                };
+            }
+
+            template <typename Buffer, typename Function>
+            void Sequence(Buffer&& buffer, Function&& func) const
+            {
+                std::unique_lock<std::mutex> guard{ m_strand->m_lock };
+
+                // Small messages stay inline only while nothing is queued ahead of them.
+                if (!m_strand->m_isBusy && !IsLarge(buffer))
+                {
+                    guard.unlock();
+                    std::forward<Function>(func)(std::forward<Buffer>(buffer));
+                    return;
+                }
+
+                m_strand->m_tasks.emplace_back(Bind(std::forward<Buffer>(buffer), std::forward<Function>(func)));
+
+                if (!m_strand->m_isBusy)
+                {
+                    m_strand->m_isBusy = true;
+                    guard.unlock();
+
+                    m_pool->Submit([pool = m_pool.get(), strand = m_strand] { Drain(*pool, *strand); });
+                }
+            }
+
+            static void Drain(const ThreadPool& pool, Strand& strand)
+            {
+                std::unique_lock<std::mutex> guard{ strand.m_lock };
+
+                while (!strand.m_tasks.empty())
+                {
+                    auto task = std::move(strand.m_tasks.front());
+                    strand.m_tasks.pop_front();
+
+                    guard.unlock();
+
+                    try
+                    {
+                        task();
+                    }
+                    catch (...)
+                    {
+                        // Keep draining, the following messages must still be delivered.
+                        pool.ReportError(std::current_exception());
+                    }
+
+                    guard.lock();
+                }
+
+                strand.m_isBusy = false;
+            }
+
+            std::shared_ptr<ThreadPool> m_pool;
+            std::shared_ptr<Strand> m_strand;
+            std::size_t m_threshold{ 0 };
+        };
+
+
+        ThresholdDeserializationScheduler() = default;
+
+        ThresholdDeserializationScheduler(std::shared_ptr<ThreadPool> pool, std::size_t threshold, bool preserveOrder = true)
+            : m_pool{ std::move(pool) },
+              m_threshold{ threshold },
+              m_preserveOrder{ preserveOrder }
+        {}
+
+        Dispatcher MakeDispatcher() const
+        {
+            return{ m_pool, m_threshold, m_preserveOrder };
+        }
+
+        const std::shared_ptr<ThreadPool>& GetThreadPool() const
+        {
+            return m_pool;
+        }
+
+        std::size_t GetThreshold() const
+        {
+            return m_threshold;
+        }
+
+        bool IsOrderPreserved() const
+        {
+            return m_preserveOrder;
+        }
+
+    private:
+        std::shared_ptr<ThreadPool> m_pool;
+        std::size_t m_threshold{ 0 };
+        bool m_preserveOrder{ true };
+    };
+
+} // Bond
+} // IPC
@@ -0,0 +1,638 @@
+#pragma once
+
+#include "BufferPool.h"
+#include "detail/Schema.h"
+#include <bond/core/reflection.h>
+#include <bond/core/traits.h>
+#include <boost/utility/string_view.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+
+namespace IPC
+{
+namespace Bond
+{
+    // ShmFlat layout: an offset-addressed encoding stored in a single blob which is read in place.
+    //
+    //  header: u32 magic, u16 version, u16 reserved, followed by the root table
+    //  table:  u32 field count, u32 reserved, 8 byte slot per schema field in declaration order
+    //  slot:   scalars (arithmetic and enum types) inline, otherwise u32 offset of the value
+    //  string: u32 size, characters
+    //  list:   u32 count, scalars packed or u32 offsets of the elements
+    //
+    // Offsets are relative to the beginning of the blob. Fields may only be appended to the schema,
+    // readers return the schema default for fields missing in older payloads.
+    template <typename T>
+    class FlatView;
+
+    template <typename T>
+    class FlatVector;
+
+
+    namespace detail
+    {
+    namespace FlatCodec
+    {
+        constexpr std::uint32_t Magic = 0x464D4853; // "SHMF"
+        constexpr std::uint16_t Version = 1;
+
+        constexpr std::size_t HeaderSize = 8;
+        constexpr std::size_t TableHeaderSize = 8;
+        constexpr std::size_t SlotSize = 8;
+
+
+        template <typename T>
+        using IsScalar = std::integral_constant<bool, std::is_arithmetic<T>::value || std::is_enum<T>::value>;
+
+        template <typename T, typename Enable = void>
+        struct Stored
+        {
+            using type = T;
+        };
+
+        template <typename T>
+        struct Stored<T, std::enable_if_t<std::is_enum<T>::value>>
+        {
+            using type = std::int32_t;
+        };
+
+
+        template <typename T, typename Enable = void>
+        struct Accessor;
+
+        template <typename T>
+        struct Accessor<T, std::enable_if_t<IsScalar<T>::value>>
+        {
+            using type = T;
+        };
+
+        template <>
+        struct Accessor<std::string>
+        {
+            using type = boost::string_view;
+        };
+
+        template <typename T, typename Allocator>
+        struct Accessor<std::vector<T, Allocator>>
+        {
+            using type = FlatVector<T>;
+        };
+
+        template <typename T>
+        struct Accessor<T, std::enable_if_t<bond::has_schema<T>::value>>
+        {
+            using type = FlatView<T>;
+        };
+
+
+        template <typename Field, typename... Fields>
+        constexpr std::size_t IndexOf()
+        {
+            constexpr bool matches[] = { std::is_same<Field, Fields>::value..., false };
+
+            std::size_t index = 0;
+
+            while (index != sizeof...(Fields) && !matches[index])
+            {
+                ++index;
+            }
+
+            return index;
+        }
+
+        template <typename Field, typename Fields>
+        struct FieldIndex;
+
+        template <typename Field, template <typename...> typename List, typename... Fields>
+        struct FieldIndex<Field, List<Fields...>> : std::integral_constant<std::size_t, IndexOf<Field, Fields...>()>
+        {
+            static_assert(IndexOf<Field, Fields...>() != sizeof...(Fields), "Field does not belong to the schema.");
+        };
+
+        template <typename Fields>
+        struct FieldCount;
+
+        template <template <typename...> typename List, typename... Fields>
+        struct FieldCount<List<Fields...>> : std::integral_constant<std::size_t, sizeof...(Fields)>
+        {};
+
+
+        inline void Check(std::size_t size, std::size_t offset, std::size_t length)
+        {
+            if (offset > size || length > size - offset)
+            {
+                throw std::out_of_range{ "Invalid flat payload." };
+            }
+        }
+
+        inline std::uint32_t LoadOffset(std::size_t size, const char* ref)
+        {
+            std::uint32_t offset;
+            std::memcpy(&offset, ref, sizeof(offset));
+
+            Check(size, offset, sizeof(std::uint32_t));
+
+            return offset;
+        }
+
+        inline std::uint32_t LoadCount(const char* base, std::uint32_t offset)
+        {
+            std::uint32_t count;
+            std::memcpy(&count, base + offset, sizeof(count));
+
+            return count;
+        }
+
+
+        template <typename T>
+        typename Accessor<T>::type Open(const char* base, std::size_t size, std::uint32_t offset, T* /*tag*/)
+        {
+            return{ base, size, offset };
+        }
+
+        inline boost::string_view Open(const char* base, std::size_t size, std::uint32_t offset, std::string* /*tag*/)
+        {
+            auto length = LoadCount(base, offset);
+
+            Check(size, offset + sizeof(std::uint32_t), length);
+
+            return{ base + offset + sizeof(std::uint32_t), length };
+        }
+
+        // Loads a value referenced by a table slot or a list element.
+        template <typename T>
+        auto Load(const char* /*base*/, std::size_t /*size*/, const char* ref, std::true_type /*isScalar*/)
+        {
+            typename Stored<T>::type value;
+            std::memcpy(&value, ref, sizeof(value));
+
+            return static_cast<T>(value);
+        }
+
+        template <typename T>
+        auto Load(const char* base, std::size_t size, const char* ref, std::false_type /*isScalar*/)
+        {
+            return Open(base, size, LoadOffset(size, ref), static_cast<T*>(nullptr));
+        }
+
+        template <typename T>
+        auto Load(const char* base, std::size_t size, const char* ref)
+        {
+            return Load<T>(base, size, ref, IsScalar<T>{});
+        }
+
+
+        template <typename T>
+        std::size_t GetSize(const T& value);
+
+        std::size_t GetSize(const std::string& value);
+
+        template <typename T, typename Allocator>
+        std::size_t GetSize(const std::vector<T, Allocator>& value);
+
+        template <typename T>
+        std::size_t GetOutOfLineSize(const T& /*value*/, std::true_type /*isScalar*/)
+        {
+            return 0;
+        }
+
+        template <typename T>
+        std::size_t GetOutOfLineSize(const T& value, std::false_type /*isScalar*/)
+        {
+            return GetSize(value);
+        }
+
+        template <typename T>
+        std::size_t GetTableSize(const T& value)
+        {
+            static_assert(std::is_same<typename Schema<T>::base, bond::no_base>::value, "Flat codec does not support inheritance.");
+
+            auto size = TableHeaderSize + SlotSize * FieldCount<typename Schema<T>::fields>::value;
+
+            Fields<T>::ForEach(
+                [&](auto field)
+                {
+                    using Field = decltype(field);
+                    using FieldType = typename Field::field_type;
+
+                    size += GetOutOfLineSize(Field::GetVariable(value), IsScalar<FieldType>{});
+                });
+
+            return size;
+        }
+
+        inline std::size_t GetSize(const std::string& value)
+        {
+            return sizeof(std::uint32_t) + value.size();
+        }
+
+        template <typename T, typename Allocator>
+        std::size_t GetSize(const std::vector<T, Allocator>& value, std::true_type /*isScalar*/)
+        {
+            return sizeof(std::uint32_t) + value.size() * sizeof(typename Stored<T>::type);
+        }
+
+        template <typename T, typename Allocator>
+        std::size_t GetSize(const std::vector<T, Allocator>& value, std::false_type /*isScalar*/)
+        {
+            auto size = sizeof(std::uint32_t) * (1 + value.size());
+
+            for (const auto& element : value)
+            {
+                size += GetSize(element);
+            }
+
+            return size;
+        }
+
+        template <typename T, typename Allocator>
+        std::size_t GetSize(const std::vector<T, Allocator>& value)
+        {
+            return GetSize(value, IsScalar<T>{});
+        }
+
+        template <typename T>
+        std::size_t GetSize(const T& value)
+        {
+            static_assert(bond::has_schema<T>::value, "Unsupported flat codec type.");
+            return GetTableSize(value);
+        }
+
+
+        class Writer
+        {
+        public:
+            explicit Writer(char* base)
+                : m_base{ base }
+            {}
+
+            std::uint32_t Reserve(std::size_t size)
+            {
+                auto offset = m_used;
+                m_used += size;
+
+                return static_cast<std::uint32_t>(offset);
+            }
+
+            char* GetPtr(std::uint32_t offset) const
+            {
+                return m_base + offset;
+            }
+
+            template <typename T>
+            void Store(std::uint32_t offset, const T& value)
+            {
+                std::memcpy(GetPtr(offset), &value, sizeof(value));
+            }
+
+            std::size_t GetUsed() const
+            {
+                return m_used;
+            }
+
+        private:
+            char* m_base;
+            std::size_t m_used{ 0 };
+        };
+
+
+        template <typename T>
+        std::uint32_t Write(Writer& writer, const T& value);
+
+        // Stores a value into a table slot or a list element, out-of-line values are appended.
+        template <typename T>
+        void Store(Writer& writer, std::uint32_t ref, const T& value, std::true_type /*isScalar*/)
+        {
+            writer.Store(ref, static_cast<typename Stored<T>::type>(value));
+        }
+
+        template <typename T>
+        void Store(Writer& writer, std::uint32_t ref, const T& value, std::false_type /*isScalar*/)
+        {
+            writer.Store(ref, Write(writer, value));
+        }
+
+        template <typename T>
+        void Store(Writer& writer, std::uint32_t ref, const T& value)
+        {
+            Store(writer, ref, value, IsScalar<T>{});
+        }
+
+        template <typename T>
+        std::uint32_t WriteTable(Writer& writer, const T& value)
+        {
+            constexpr auto count = FieldCount<typename Schema<T>::fields>::value;
+
+            auto offset = writer.Reserve(TableHeaderSize + SlotSize * count);
+
+            std::memset(writer.GetPtr(offset), 0, TableHeaderSize + SlotSize * count);
+            writer.Store(offset, static_cast<std::uint32_t>(count));
+
+            Fields<T>::ForEach(
+                [&](auto field)
+                {
+                    using Field = decltype(field);
+
+                    constexpr auto index = FieldIndex<Field, typename Schema<T>::fields>::value;
+
+                    Store(writer, static_cast<std::uint32_t>(offset + TableHeaderSize + SlotSize * index), Field::GetVariable(value));
+                });
+
+            return offset;
+        }
+
+        inline std::uint32_t Write(Writer& writer, const std::string& value)
+        {
+            auto offset = writer.Reserve(GetSize(value));
+
+            writer.Store(offset, static_cast<std::uint32_t>(value.size()));
+            std::memcpy(writer.GetPtr(offset + sizeof(std::uint32_t)), value.data(), value.size());
+
+            return offset;
+        }
+
+        template <typename T, typename Allocator>
+        std::uint32_t Write(Writer& writer, const std::vector<T, Allocator>& value)
+        {
+            using ElementSize = std::integral_constant<std::size_t, IsScalar<T>::value ? sizeof(typename Stored<T>::type) : sizeof(std::uint32_t)>;
+
+            auto offset = writer.Reserve(sizeof(std::uint32_t) + ElementSize::value * value.size());
+
+            writer.Store(offset, static_cast<std::uint32_t>(value.size()));
+
+            std::uint32_t ref = offset + sizeof(std::uint32_t);
+
+            for (const auto& element : value)
+            {
+                Store<T>(writer, ref, element);
+                ref += ElementSize::value;
+            }
+
+            return offset;
+        }
+
+        template <typename T>
+        std::uint32_t Write(Writer& writer, const T& value)
+        {
+            static_assert(bond::has_schema<T>::value, "Unsupported flat codec type.");
+            return WriteTable(writer, value);
+        }
+
+
+        // Returns the schema default of a field missing in the payload, accessors refer to static storage.
+        template <typename T>
+        auto LoadDefault(const T& value, std::true_type /*isScalar*/)
+        {
+            return value;
+        }
+
+        inline boost::string_view LoadDefault(const std::string& value, std::false_type /*isScalar*/)
+        {
+            return value;
+        }
+
+        template <typename T, typename Allocator>
+        FlatVector<T> LoadDefault(const std::vector<T, Allocator>& /*value*/, std::false_type /*isScalar*/)
+        {
+            return{};   // Schema defaults of containers are always empty.
+        }
+
+        template <typename T>
+        FlatView<T> LoadDefault(const T& /*value*/, std::false_type /*isScalar*/)
+        {
+            // Struct fields always default to a default constructed struct, which is encoded once.
+            static const std::vector<char> s_table = []
+            {
+                const auto& value = GetDefault<T>();
+
+                std::vector<char> table(GetSize(value));
+
+                Writer writer{ table.data() };
+                Write(writer, value);
+
+                return table;
+            }();
+
+            return{ s_table.data(), s_table.size(), 0 };
+        }
+
+    } // FlatCodec
+    } // detail
+
+
+    // Accessor of a struct encoded with FlatSerialize, each field is read in place in constant time.
+    // Views do not own the payload, which must outlive them and everything obtained from them.
+    template <typename T>
+    class FlatView
+    {
+    public:
+        FlatView() = default;
+
+        FlatView(const char* base, std::size_t size, std::uint32_t offset)
+            : m_base{ base },
+              m_size{ size },
+              m_offset{ offset }
+        {
+            using namespace detail::FlatCodec;
+
+            Check(size, offset, TableHeaderSize);
+
+            m_count = LoadCount(base, offset);
+
+            Check(size, offset + TableHeaderSize, std::size_t{ m_count } * SlotSize);
+        }
+
+        template <typename Field>
+        auto Get() const
+        {
+            using namespace detail::FlatCodec;
+            using FieldType = typename Field::field_type;
+
+            constexpr auto index = FieldIndex<Field, typename detail::Schema<T>::fields>::value;
+
+            if (index < m_count)
+            {
+                return Load<FieldType>(m_base, m_size, m_base + m_offset + TableHeaderSize + SlotSize * index);
+            }
+
+            return LoadDefault(Field::GetVariable(detail::GetDefault<T>()), IsScalar<FieldType>{});
+        }
+
+        // Returns the number of fields present in the payload.
+        std::size_t GetFieldCount() const
+        {
+            return m_count;
+        }
+
+    private:
+        const char* m_base{ nullptr };
+        std::size_t m_size{ 0 };
+        std::uint32_t m_offset{ 0 };
+        std::uint32_t m_count{ 0 };
+    };
+
+
+    template <typename T>
+    class FlatVector
+    {
+    public:
+        FlatVector() = default;
+
+        FlatVector(const char* base, std::size_t size, std::uint32_t offset)
+            : m_base{ base },
+              m_size{ size },
+              m_offset{ offset }
+        {
+            using namespace detail::FlatCodec;
+
+            m_count = LoadCount(base, offset);
+
+            Check(size, offset + sizeof(std::uint32_t), std::size_t{ m_count } * ElementSize::value);
+        }
+
+        std::size_t size() const
+        {
+            return m_count;
+        }
+
+        bool empty() const
+        {
+            return m_count == 0;
+        }
+
+        auto operator[](std::size_t index) const
+        {
+            if (index >= m_count)
+            {
+                throw std::out_of_range{ "Index is out of range." };
+            }
+
+            return detail::FlatCodec::Load<T>(m_base, m_size, m_base + m_offset + sizeof(std::uint32_t) + ElementSize::value * index);
+        }
+
+    private:
+        using ElementSize = std::integral_constant<
+            std::size_t,
+            detail::FlatCodec::IsScalar<T>::value ? sizeof(typename detail::FlatCodec::Stored<T>::type) : sizeof(std::uint32_t)>;
+
+        const char* m_base{ nullptr };
+        std::size_t m_size{ 0 };
+        std::uint32_t m_offset{ 0 };
+        std::uint32_t m_count{ 0 };
+    };
+
+
+    // Encodes T in the ShmFlat layout into a single blob. Supported field types are arithmetic, enum,
+    // string, std::vector of those and structs without a base, recursively.
+    template <typename BufferPool, typename T>
+    typename BufferPool::ConstBuffer FlatSerialize(BufferPool& pool, const T& value)
+    {
+        using namespace detail::FlatCodec;
+
+        const auto size = HeaderSize + GetSize(value);
+
+        if (size > (std::numeric_limits<std::uint32_t>::max)())
+        {
+            throw std::length_error{ "Flat payload is too large." };
+        }
+
+        auto blob = pool.TakeBlob();
+        blob->resize(size, boost::container::default_init);
+
+        Writer writer{ blob->data() };
+
+        auto header = writer.Reserve(HeaderSize);
+        writer.Store(header, Magic);
+        writer.Store(header + 4, Version);
+        writer.Store(header + 6, std::uint16_t{ 0 });
+
+        Write(writer, value);
+        assert(writer.GetUsed() == size);
+
+        auto buffer = pool.TakeBuffer();
+        buffer->push_back(std::move(blob));
+
+        return std::move(buffer);
+    }
+
+
+    // Message holding a struct in the ShmFlat layout. Serializer passes it through as is, so it can be
+    // used as Request or Response of Client and Server to read fields of large messages without decoding.
+    template <typename T, typename BufferPool = DefaultBufferPool>
+    class FlatObject
+    {
+    public:
+        using ConstBuffer = typename BufferPool::ConstBuffer;
+
+        FlatObject() = default;
+
+        FlatObject(BufferPool& pool, const T& value)
+            : FlatObject{ FlatSerialize(pool, value) }
+        {}
+
+        explicit FlatObject(ConstBuffer buffer)
+            : m_buffer{ std::move(buffer) }
+        {
+            using namespace detail::FlatCodec;
+
+            if (!m_buffer || std::next(m_buffer.begin()) != m_buffer.end())
+            {
+                throw std::invalid_argument{ "Flat object must occupy a single blob." };
+            }
+
+            const auto& blob = *m_buffer.begin();
+
+            std::uint32_t magic = 0;
+            std::uint16_t version = 0;
+
+            if (blob.size() >= HeaderSize)
+            {
+                std::memcpy(&magic, blob.data(), sizeof(magic));
+                std::memcpy(&version, blob.data() + sizeof(magic), sizeof(version));
+            }
+
+            if (magic != Magic || version != Version)
+            {
+                throw std::invalid_argument{ "Invalid flat object." };
+            }
+
+            m_view = FlatView<T>{ blob.data(), blob.size(), static_cast<std::uint32_t>(HeaderSize) };
+        }
+
+        explicit operator bool() const
+        {
+            return static_cast<bool>(m_buffer);
+        }
+
+        const FlatView<T>& operator*() const
+        {
+            return m_view;
+        }
+
+        const FlatView<T>* operator->() const
+        {
+            return &m_view;
+        }
+
+        const ConstBuffer& GetBuffer() const
+        {
+            return m_buffer;
+        }
+
+    private:
+        ConstBuffer m_buffer;
+        FlatView<T> m_view;
+    };
+
+} // Bond
+} // IPC
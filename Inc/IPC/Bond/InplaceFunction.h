@@ -0,0 +1,193 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+namespace IPC
+{
+namespace Bond
+{
+    template <typename Signature, std::size_t Capacity = 64>
+    class InplaceFunction;
+
+
+    // Move-only counterpart of std::function which keeps callables of up to Capacity bytes in place and
+    // only falls back to the heap for larger ones or ones that may throw when moved. Accepts move-only
+    // callables (e.g. holding a std::promise), so transaction callbacks need no shared_ptr around them.
+    template <typename R, typename... Args, std::size_t Capacity>
+    class InplaceFunction<R(Args...), Capacity>
+    {
+    public:
+        InplaceFunction() = default;
+
+        InplaceFunction(std::nullptr_t) noexcept
+        {}
+
+        template <typename Function, typename F = std::decay_t<Function>, std::enable_if_t<!std::is_same<F, InplaceFunction>::value>* = nullptr>
+        InplaceFunction(Function&& func)
+        {
+            Construct<F>(std::forward<Function>(func), FitsInline<F>{});
+            m_ops = &GetOps<F>(FitsInline<F>{});
+        }
+
+        InplaceFunction(InplaceFunction&& other) noexcept
+            : m_ops{ other.m_ops }
+        {
+            if (m_ops)
+            {
+                m_ops->m_move(&other.m_storage, &m_storage);
+                other.m_ops = nullptr;
+            }
+        }
+
+        InplaceFunction& operator=(InplaceFunction&& other) noexcept
+        {
+            if (this != &other)
+            {
+                Reset();
+
+                if (other.m_ops)
+                {
+                    other.m_ops->m_move(&other.m_storage, &m_storage);
+                    m_ops = other.m_ops;
+                    other.m_ops = nullptr;
+                }
+            }
+
+            return *this;
+        }
+
+        InplaceFunction(const InplaceFunction& other) = delete;
+        InplaceFunction& operator=(const InplaceFunction& other) = delete;
+
+        ~InplaceFunction()
+        {
+            Reset();
+        }
+
+        R operator()(Args... args)
+        {
+            if (!m_ops)
+            {
+                throw std::bad_function_call{};
+            }
+
+            return m_ops->m_invoke(&m_storage, std::forward<Args>(args)...);
+        }
+
+        explicit operator bool() const noexcept
+        {
+            return m_ops != nullptr;
+        }
+
+        // Returns true when the callable is stored in place.
+        bool IsInline() const noexcept
+        {
+            return m_ops && m_ops->m_isInline;
+        }
+
+    private:
+        using Storage = std::aligned_storage_t<Capacity, alignof(std::max_align_t)>;
+
+        template <typename F>
+        using FitsInline = std::integral_constant<
+            bool,
+            sizeof(F) <= sizeof(Storage) && alignof(Storage) % alignof(F) == 0 && std::is_nothrow_move_constructible<F>::value>;
+
+        struct Ops
+        {
+            R (*m_invoke)(void* storage, Args&&... args);
+            void (*m_move)(void* from, void* to);   // Leaves nothing behind to destroy.
+            void (*m_destroy)(void* storage);
+            bool m_isInline;
+        };
+
+        template <typename F>
+        struct InlineOps
+        {
+            static R Invoke(void* storage, Args&&... args)
+            {
+                return (*static_cast<F*>(storage))(std::forward<Args>(args)...);
+            }
+
+            static void Move(void* from, void* to)
+            {
+                new (to) F(std::move(*static_cast<F*>(from)));
+                static_cast<F*>(from)->~F();
+            }
+
+            static void Destroy(void* storage)
+            {
+                static_cast<F*>(storage)->~F();
+            }
+        };
+
+        template <typename F>
+        struct HeapOps
+        {
+            static F*& Get(void* storage)
+            {
+                return *static_cast<F**>(storage);
+            }
+
+            static R Invoke(void* storage, Args&&... args)
+            {
+                return (*Get(storage))(std::forward<Args>(args)...);
+            }
+
+            static void Move(void* from, void* to)
+            {
+                new (to) F*{ Get(from) };
+            }
+
+            static void Destroy(void* storage)
+            {
+                delete Get(storage);
+            }
+        };
+
+        template <typename F>
+        static const Ops& GetOps(std::true_type /*isInline*/)
+        {
+            static const Ops s_ops{ &InlineOps<F>::Invoke, &InlineOps<F>::Move, &InlineOps<F>::Destroy, true };
+            return s_ops;
+        }
+
+        template <typename F>
+        static const Ops& GetOps(std::false_type /*isInline*/)
+        {
+            static const Ops s_ops{ &HeapOps<F>::Invoke, &HeapOps<F>::Move, &HeapOps<F>::Destroy, false };
+            return s_ops;
+        }
+
+        template <typename F, typename Function>
+        void Construct(Function&& func, std::true_type /*isInline*/)
+        {
+            new (&m_storage) F(std::forward<Function>(func));
+        }
+
+        template <typename F, typename Function>
+        void Construct(Function&& func, std::false_type /*isInline*/)
+        {
+            new (&m_storage) F*{ new F(std::forward<Function>(func)) };
+        }
+
+        void Reset() noexcept
+        {
+            if (m_ops)
+            {
+                m_ops->m_destroy(&m_storage);
+                m_ops = nullptr;
+            }
+        }
+
+        const Ops* m_ops{ nullptr };
+        Storage m_storage;
+    };
+
+} // Bond
+} // IPC
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "DefaultTraits.h"
+#include "InplaceFunction.h"
+#include <cstddef>
+
+
+namespace IPC
+{
+namespace Bond
+{
+    namespace detail
+    {
+        // Replaces the type erased callback (e.g. std::function) the transport keeps per transaction.
+        template <typename Context, std::size_t Capacity>
+        struct InplaceContext
+        {
+            using type = Context;
+        };
+
+        template <template <typename> typename Function, typename R, typename... Args, std::size_t Capacity>
+        struct InplaceContext<Function<R(Args...)>, Capacity>
+        {
+            using type = InplaceFunction<R(Args...), Capacity>;
+        };
+
+    } // detail
+
+
+    // Traits which store the callbacks of outstanding client transactions in InplaceFunction, so handing
+    // a call to the transport makes no allocation for callbacks of up to CallbackCapacity bytes. The rest
+    // of the transaction management (e.g. timeouts) is taken from Traits.
+    template <typename Traits = DefaultTraits, std::size_t Capacity = 128>
+    struct InplaceCallbackTraits : Traits
+    {
+        static constexpr std::size_t CallbackCapacity = Capacity;
+
+        template <typename Context>
+        using TransactionManager = typename Traits::template TransactionManager<typename detail::InplaceContext<Context, Capacity>::type>;
+    };
+
+} // Bond
+} // IPC
@@ -18,13 +18,18 @@ namespace Bond
     public:
         InputBuffer() = default;
 
-        InputBuffer(ConstBuffer buffer, std::shared_ptr<SharedMemory> memory)
+        // Blobs residing in otherMemory are linked from there, e.g. the ones of buffers with resolved peer references.
+        InputBuffer(ConstBuffer buffer, std::shared_ptr<SharedMemory> memory, std::shared_ptr<SharedMemory> otherMemory = {})
             : InputBuffer{ buffer ? InputBuffer{ std::move(memory), buffer, buffer.begin(), buffer.end() } : InputBuffer{} }
-        {}
+        {
+            m_otherMemory = std::move(otherMemory);
+        }
 
-        InputBuffer(const typename ConstBuffer::Range& range, std::shared_ptr<SharedMemory> memory)
+        InputBuffer(const typename ConstBuffer::Range& range, std::shared_ptr<SharedMemory> memory, std::shared_ptr<SharedMemory> otherMemory = {})
             : InputBuffer{ std::move(memory), range.m_buffer, range.m_firstBlob, range.m_lastBlob, range.m_firstOffset, range.m_lastOffset }
-        {}
+        {
+            m_otherMemory = std::move(otherMemory);
+        }
 
         template <typename T>
         void Read(T& value)
@@ -48,7 +53,20 @@ namespace Bond
         {
             // Do not merge if spans over multiple blobs.
             const auto& blob = *m_blob;
-            ReadSingle(size, [&] { bondBlob.assign(BlobCast(blob, m_memory), static_cast<std::uint32_t>(m_ptr - blob.data()), size); });
+            ReadSingle(
+                size,
+                [&]
+                {
+                    // Blobs read from the same source blob share a single holder, kept by the owner of borrowed views.
+                    auto& holder = (m_owner ? m_owner->m_holder : m_holder).m_blob;
+
+                    if (holder.content() != blob.data() || holder.size() != blob.size())
+                    {
+                        holder = BlobCast(blob, GetMemory(blob.data()));
+                    }
+
+                    bondBlob.assign(holder, static_cast<std::uint32_t>(m_ptr - blob.data()), size);
+                });
         }
 
         const void* Allocate(std::uint32_t size)
@@ -91,12 +109,63 @@ namespace Bond
 
         const std::shared_ptr<SharedMemory>& GetMemory() const
         {
-            return m_memory;
+            return m_owner ? m_owner->m_memory : m_memory;
+        }
+
+        // Returns a view at the current position which holds no references to the memory and the blobs,
+        // so copying it involves no atomic operations. The view must not outlive this buffer (or the one
+        // it was borrowed from). Ownership is taken only by what escapes the view: bond::blob values and
+        // buffers created by CreateInputBuffer for bonded<T> fields.
+        InputBuffer Borrow() const
+        {
+            InputBuffer view;
+
+            view.m_ptr = m_ptr;
+            view.m_ptrEnd = m_ptrEnd;
+            view.m_blob = m_blob;
+            view.m_blobEnd = m_blobEnd;
+            view.m_isEof = m_isEof;
+            view.m_lastOffset = m_lastOffset;
+            view.m_owner = m_owner ? m_owner : this;
+
+            return view;
+        }
+
+        bool IsBorrowed() const
+        {
+            return m_owner != nullptr;
         }
 
     private:
         using BlobIterator = decltype(std::declval<ConstBuffer>().begin());
 
+        // Left behind by copies, which would otherwise update its reference count.
+        struct HolderCache
+        {
+            HolderCache() = default;
+
+            HolderCache(const HolderCache& /*other*/) noexcept
+            {}
+
+            HolderCache& operator=(const HolderCache& /*other*/) noexcept
+            {
+                return *this;
+            }
+
+            bond::blob m_blob;
+        };
+
+        const std::shared_ptr<SharedMemory>& GetOtherMemory() const
+        {
+            return m_owner ? m_owner->m_otherMemory : m_otherMemory;
+        }
+
+        const std::shared_ptr<SharedMemory>& GetMemory(const char* data) const
+        {
+            const auto& otherMemory = GetOtherMemory();
+            return otherMemory && otherMemory->Contains(data) ? otherMemory : GetMemory();
+        }
+
         InputBuffer(
             std::shared_ptr<SharedMemory> memory,
             ConstBuffer buffer,
@@ -221,13 +290,18 @@ namespace Bond
             return buffer;
         }
 
+        const ConstBuffer& GetBuffer() const
+        {
+            return m_owner ? m_owner->m_buffer : m_buffer;
+        }
+
         friend auto GetBufferRange(const InputBuffer& begin, const InputBuffer& end)
         {
-            assert(begin.m_buffer == end.m_buffer);
+            assert(begin.GetBuffer() == end.GetBuffer());
             assert(end.IsEof() || !begin.IsEof());
 
             return typename ConstBuffer::Range{
-                begin.m_buffer,
+                begin.GetBuffer(),
                 begin.m_blob,
                 begin.IsEof() ? 0 : std::size_t(begin.m_ptr - begin.m_blob->data()),
                 end.m_blob,
@@ -236,7 +310,7 @@ namespace Bond
 
         friend auto CreateInputBuffer(const InputBuffer& other, const typename ConstBuffer::Range& range)
         {
-            return InputBuffer{ range, other.m_memory };
+            return InputBuffer{ range, other.GetMemory(), other.GetOtherMemory() };
         }
 
 
@@ -247,7 +321,10 @@ namespace Bond
         bool m_isEof{ m_blob == m_blobEnd };
         std::size_t m_lastOffset{ 0 };
         std::shared_ptr<SharedMemory> m_memory; // Must be declared before m_buffer.
+        std::shared_ptr<SharedMemory> m_otherMemory;
         ConstBuffer m_buffer{};
+        const InputBuffer* m_owner{ nullptr };  // Set for borrowed views, which own nothing themselves.
+        mutable HolderCache m_holder;
     };
 
 
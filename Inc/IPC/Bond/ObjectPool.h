@@ -0,0 +1,198 @@
+#pragma once
+
+#include "detail/Schema.h"
+#include <bond/core/traits.h>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+
+namespace IPC
+{
+namespace Bond
+{
+    namespace detail
+    {
+        template <typename T, typename = void>
+        struct IsClearable : std::false_type
+        {};
+
+        template <typename T>
+        struct IsClearable<T, decltype(std::declval<T&>().clear(), std::declval<const T&>().empty(), void())> : std::true_type
+        {};
+
+
+        template <typename T>
+        void ResetObject(T& value, const T& prototype);
+
+        template <typename T>
+        void ResetValue(T& value, const T& prototype, std::false_type /*isClearable*/)
+        {
+            value = prototype;
+        }
+
+        template <typename T>
+        void ResetValue(T& value, const T& prototype, std::true_type /*isClearable*/)
+        {
+            // Keeps the capacity of strings and containers.
+            if (prototype.empty())
+            {
+                value.clear();
+            }
+            else
+            {
+                value = prototype;
+            }
+        }
+
+        template <typename T>
+        void ResetValue(T& value, const T& prototype)
+        {
+            ResetValue(value, prototype, IsClearable<T>{});
+        }
+
+        template <typename T>
+        void ResetFields(T& /*value*/, const T& /*prototype*/, bond::no_base*)
+        {}
+
+        template <typename T, typename Base>
+        void ResetFields(T& value, const T& prototype, Base*)
+        {
+            ResetObject(static_cast<Base&>(value), static_cast<const Base&>(prototype));
+        }
+
+        template <typename T>
+        void ResetObject(T& value, const T& prototype, std::false_type /*hasSchema*/)
+        {
+            ResetValue(value, prototype);
+        }
+
+        template <typename T>
+        void ResetObject(T& value, const T& prototype, std::true_type /*hasSchema*/)
+        {
+            ResetFields(value, prototype, static_cast<typename Schema<T>::base*>(nullptr));
+
+            Fields<T>::ForEach(
+                [&](auto field)
+                {
+                    using Field = decltype(field);
+                    using FieldType = typename Field::field_type;
+
+                    ResetObject(Field::GetVariable(value), Field::GetVariable(prototype), bond::has_schema<FieldType>{});
+                });
+        }
+
+        // Brings the value back to its default state while retaining the allocated memory where possible.
+        template <typename T>
+        void ResetObject(T& value, const T& prototype)
+        {
+            ResetObject(value, prototype, bond::has_schema<T>{});
+        }
+
+    } // detail
+
+
+    // Hands out a new object every time, the holder keeps it at a stable address.
+    template <typename T>
+    class NoObjectPool
+    {
+    public:
+        using Holder = std::unique_ptr<T>;
+
+        Holder Take() const
+        {
+            return std::make_unique<T>();
+        }
+    };
+
+
+    // Hands out previously used objects so deserialization can reuse their string and container capacity.
+    // Objects are reset when the holder is released, up to Capacity of them are kept for reuse.
+    template <typename T, std::size_t Capacity = 64>
+    class RecyclingObjectPool
+    {
+        struct State
+        {
+            std::mutex m_lock;
+            std::vector<std::unique_ptr<T>> m_objects;
+        };
+
+    public:
+        class Recycler
+        {
+        public:
+            Recycler() = default;
+
+            void operator()(T* ptr) const
+            {
+                std::unique_ptr<T> object{ ptr };
+
+                if (!m_state)
+                {
+                    return;
+                }
+
+                try
+                {
+                    detail::ResetObject(*object, detail::GetDefault<T>());
+                }
+                catch (...)
+                {
+                    return;
+                }
+
+                std::lock_guard<std::mutex> guard{ m_state->m_lock };
+
+                if (m_state->m_objects.size() < Capacity)
+                {
+                    m_state->m_objects.push_back(std::move(object));
+                }
+            }
+
+        private:
+            friend RecyclingObjectPool;
+
+            explicit Recycler(std::shared_ptr<State> state)
+                : m_state{ std::move(state) }
+            {}
+
+            std::shared_ptr<State> m_state;
+        };
+
+        using Holder = std::unique_ptr<T, Recycler>;
+
+        Holder Take() const
+        {
+            std::unique_ptr<T> object;
+            {
+                std::lock_guard<std::mutex> guard{ m_state->m_lock };
+
+                if (!m_state->m_objects.empty())
+                {
+                    object = std::move(m_state->m_objects.back());
+                    m_state->m_objects.pop_back();
+                }
+            }
+
+            if (!object)
+            {
+                object = std::make_unique<T>();
+            }
+
+            return Holder{ object.release(), Recycler{ m_state } };
+        }
+
+        std::size_t GetAvailableCount() const
+        {
+            std::lock_guard<std::mutex> guard{ m_state->m_lock };
+            return m_state->m_objects.size();
+        }
+
+    private:
+        std::shared_ptr<State> m_state{ std::make_shared<State>() };
+    };
+
+} // Bond
+} // IPC
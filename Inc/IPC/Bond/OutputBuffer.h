@@ -11,14 +11,17 @@ namespace IPC
 {
 namespace Bond
 {
+    // Copies of bond::blob values of at least alignedBlobSize bytes start a new pool blob, so receivers read
+    // their payload cache-line aligned in place (e.g. for SIMD kernels). Zero disables it.
     template <typename BufferPool>
     class OutputBuffer
     {
     public:
-        explicit OutputBuffer(std::shared_ptr<BufferPool> pool, std::size_t minBlobSize = 0)
+        explicit OutputBuffer(std::shared_ptr<BufferPool> pool, std::size_t minBlobSize = 0, std::size_t alignedBlobSize = 0)
             : m_buffer{ pool->TakeBuffer() },
               m_pool{ std::move(pool) },
-              m_minBlobSize{ minBlobSize != 0 ? minBlobSize : 4096 }
+              m_minBlobSize{ minBlobSize != 0 ? minBlobSize : 4096 },
+              m_alignedBlobSize{ alignedBlobSize }
         {
             TakeBlob();
         }
@@ -62,7 +65,7 @@ namespace Bond
 
         void Write(const bond::blob& blob)
         {
-            Write(BlobCast<typename BufferPool::ConstBlob>(blob), blob);
+            Write(m_blobCast(blob), blob);
         }
 
         void Write(const typename BufferPool::ConstBuffer& buffer)
@@ -78,40 +81,7 @@ namespace Bond
 
         void Write(const typename BufferPool::ConstBuffer::Range& range)
         {
-            if (!range.IsEmpty())
-            {
-                const auto& first = range.m_firstBlob;
-
-                auto length = std::distance(
-                    first,
-                    range.m_lastOffset != 0 ? std::next(range.m_lastBlob) : range.m_lastBlob);
-
-                assert(length != 0);
-
-                if (length == 1)
-                {
-                    Write(first->GetRange(
-                        range.m_firstOffset,
-                        (range.m_lastOffset != 0 ? range.m_lastOffset : first->size()) - range.m_firstOffset));
-                }
-                else
-                {
-                    auto last = std::next(first, length - 1);
-
-                    Write(range.m_firstOffset != 0
-                        ? first->GetRange(range.m_firstOffset, first->size() - range.m_firstOffset)
-                        : *first);
-
-                    for (auto it = std::next(first); it != last; ++it)
-                    {
-                        Write(*it);
-                    }
-
-                    Write(range.m_lastOffset != 0
-                        ? last->GetRange(0, range.m_lastOffset)
-                        : *last);
-                }
-            }
+            ForEachBlob(range, [this](const auto& blob) { Write(blob); });
         }
 
         template<typename T>
@@ -162,6 +132,96 @@ namespace Bond
             return m_pool;
         }
 
+        // Returns the number of bytes written since construction or the last TakeChunk.
+        std::size_t GetSize() const
+        {
+            return m_size + (m_ptr - m_blob->data());
+        }
+
+        // Returns the data written so far and continues with an empty buffer, so a message
+        // can be transferred in parts while it is being written.
+        typename BufferPool::ConstBuffer TakeChunk()
+        {
+            Flush();
+
+            typename BufferPool::ConstBuffer chunk{ std::move(m_buffer) };
+            m_buffer = m_pool->TakeBuffer();
+            m_size = 0;
+
+            return chunk;
+        }
+
+    protected:
+        // Appends the blob without copying when it lives in the pool memory or can be referenced by the peer.
+        bool Share(const bond::blob& blob)
+        {
+            return Share(m_blobCast(blob));
+        }
+
+        bool Share(const typename BufferPool::ConstBlob& blob)
+        {
+            if (blob && m_pool->GetMemory()->Contains(blob.data()))
+            {
+                assert(m_pool->GetMemory()->Contains(blob.data() + blob.size() - 1));
+
+                Flush();
+                m_buffer->push_back(blob);
+                m_size += blob.size();
+            }
+            else if (auto reference = m_pool->MakeReference(blob))
+            {
+                Flush();
+                m_size += reference.size();
+                m_buffer->push_back(std::move(reference));
+            }
+            else
+            {
+                return false;
+            }
+
+            return true;
+        }
+
+        // Invokes func with the part of every blob covered by range.
+        template <typename Function>
+        static void ForEachBlob(const typename BufferPool::ConstBuffer::Range& range, Function&& func)
+        {
+            if (!range.IsEmpty())
+            {
+                const auto& first = range.m_firstBlob;
+
+                auto length = std::distance(
+                    first,
+                    range.m_lastOffset != 0 ? std::next(range.m_lastBlob) : range.m_lastBlob);
+
+                assert(length != 0);
+
+                if (length == 1)
+                {
+                    func(first->GetRange(
+                        range.m_firstOffset,
+                        (range.m_lastOffset != 0 ? range.m_lastOffset : first->size()) - range.m_firstOffset));
+                }
+                else
+                {
+                    auto last = std::next(first, length - 1);
+
+                    func(range.m_firstOffset != 0
+                        ? first->GetRange(range.m_firstOffset, first->size() - range.m_firstOffset)
+                        : *first);
+
+                    for (auto it = std::next(first); it != last; ++it)
+                    {
+                        func(*it);
+                    }
+
+                    func(range.m_lastOffset != 0
+                        ? last->GetRange(0, range.m_lastOffset)
+                        : *last);
+                }
+            }
+        }
+
     private:
         void TakeBlob()
         {
@@ -180,6 +240,7 @@ namespace Bond
             {
                 m_blob->resize(offset);
                 m_buffer->push_back(std::move(m_blob));
+                m_size += offset;
 
                 return true;
             }
@@ -190,15 +251,14 @@ namespace Bond
         template <typename OtherBlob>
         void Write(const typename BufferPool::ConstBlob& blob, const OtherBlob& otherBlob)
         {
-            if (blob && m_pool->GetMemory()->Contains(blob.data()))
+            if (!Share(blob))
             {
-                assert(m_pool->GetMemory()->Contains(blob.data() + blob.size() - 1));
+                if (m_alignedBlobSize != 0 && otherBlob.size() >= m_alignedBlobSize)
+                {
+                    // Pool blobs start at a cache line.
+                    Flush();
+                }
 
-                Flush();
-                m_buffer->push_back(blob);
-            }
-            else
-            {
                 Write(otherBlob.data(), static_cast<uint32_t>(otherBlob.size()));
             }
         }
@@ -210,7 +270,7 @@ namespace Bond
 
         friend auto CreateOutputBuffer(const OutputBuffer& other)
         {
-            return OutputBuffer{ other.m_pool };
+            return OutputBuffer{ other.m_pool, 0, other.m_alignedBlobSize };
         }
 
         char* m_ptr{ nullptr };
@@ -219,6 +279,9 @@ namespace Bond
         typename BufferPool::Buffer m_buffer;
         std::shared_ptr<BufferPool> m_pool;
         std::size_t m_minBlobSize;
+        std::size_t m_alignedBlobSize;
+        std::size_t m_size{ 0 };    // Bytes in m_buffer.
+        BlobCastCache<typename BufferPool::ConstBlob> m_blobCast;
     };
 
 
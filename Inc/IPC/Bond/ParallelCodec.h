@@ -0,0 +1,152 @@
+#pragma once
+
+#include "StaticCodec.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <memory>
+#include <vector>
+
+
+namespace IPC
+{
+namespace Bond
+{
+    namespace detail
+    {
+    namespace ParallelCodec
+    {
+        struct Options
+        {
+            ThreadPool& m_threadPool;
+            std::size_t m_minChunkLength;
+            std::size_t m_minBlobSize;
+        };
+
+
+        template <typename Encoding, typename BufferPool, typename T>
+        void WriteField(OutputBuffer<BufferPool>& output, const T& value, const Options& /*options*/)
+        {
+            StaticCodec::WriteValue<Encoding>(output, value);
+        }
+
+        template <typename Encoding, typename BufferPool, typename T, typename Allocator>
+        void WriteField(OutputBuffer<BufferPool>& output, const std::vector<T, Allocator>& list, const Options& options)
+        {
+            const auto chunkCount = (std::min)(
+                list.size() / (std::max)(options.m_minChunkLength, std::size_t{ 1 }),
+                options.m_threadPool.GetThreadCount() + 1);
+
+            if (chunkCount < 2)
+            {
+                StaticCodec::WriteValue<Encoding>(output, list);
+                return;
+            }
+
+            using ConstBuffer = typename BufferPool::ConstBuffer;
+
+            // The element count is known upfront, so the header needs no fix up once the chunks are done.
+            Encoding::WriteContainerBegin(output, StaticCodec::DataType<T>::value, static_cast<std::uint32_t>(list.size()));
+
+            const auto chunkLength = list.size() / chunkCount;
+
+            auto encode = [&list, pool = output.GetBufferPool(), minBlobSize = options.m_minBlobSize](std::size_t begin, std::size_t end)
+            {
+                OutputBuffer<BufferPool> chunk{ pool, minBlobSize };
+
+                for (auto i = begin; i != end; ++i)
+                {
+                    StaticCodec::WriteValue<Encoding>(chunk, list[i]);
+                }
+
+                return std::move(chunk).GetBuffer();
+            };
+
+            std::vector<std::future<ConstBuffer>> chunks;
+            chunks.reserve(chunkCount - 1);
+
+            for (std::size_t i = 1; i < chunkCount; ++i)
+            {
+                std::packaged_task<ConstBuffer()> task{
+                    [encode, begin = i * chunkLength, end = i + 1 != chunkCount ? (i + 1) * chunkLength : list.size()]
+                    {
+                        return encode(begin, end);
+                    } };
+
+                chunks.push_back(task.get_future());
+                options.m_threadPool.Submit(std::move(task));
+            }
+
+            // The calling thread encodes the first chunk in place while the pool works on the rest.
+            std::exception_ptr error;
+
+            try
+            {
+                for (std::size_t i = 0; i < chunkLength; ++i)
+                {
+                    StaticCodec::WriteValue<Encoding>(output, list[i]);
+                }
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+
+            for (auto& chunk : chunks)
+            {
+                // Tasks reference the list, so all of them must finish before leaving.
+                chunk.wait();
+            }
+
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+
+            for (auto& chunk : chunks)
+            {
+                // Blobs come from the same pool and are linked into the output without copying.
+                output.Write(chunk.get());
+            }
+        }
+
+    } // ParallelCodec
+    } // detail
+
+
+    // Encodes T like StaticSerialize, except that elements of top-level list fields holding at least
+    // 2 * minChunkLength elements are split into ranges encoded concurrently into separate blobs, which
+    // are then stitched into the output in order. The output is wire compatible with bond. Fields may
+    // be of arithmetic, enum, string, flat struct or std::vector types. Must not be called from a thread
+    // of threadPool itself.
+    template <typename Encoding, typename BufferPool, typename T>
+    typename BufferPool::ConstBuffer ParallelSerialize(
+        std::shared_ptr<BufferPool> pool,
+        const T& value,
+        bool marshal,
+        ThreadPool& threadPool,
+        std::size_t minChunkLength = 4096,
+        std::size_t minBlobSize = 0)
+    {
+        const detail::ParallelCodec::Options options{ threadPool, minChunkLength, minBlobSize };
+
+        OutputBuffer<BufferPool> output{ std::move(pool), minBlobSize };
+
+        if (marshal)
+        {
+            output.Write(static_cast<std::uint16_t>(Encoding::Protocol));
+            output.Write(static_cast<std::uint16_t>(Encoding::Version));
+        }
+
+        detail::StaticCodec::Encode<Encoding>(
+            output,
+            value,
+            [&](const auto& fieldValue) { detail::ParallelCodec::WriteField<Encoding>(output, fieldValue, options); });
+
+        return std::move(output).GetBuffer();
+    }
+
+} // Bond
+} // IPC
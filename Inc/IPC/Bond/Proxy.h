@@ -0,0 +1,95 @@
+#pragma once
+
+#include "detail/ComponentBase.h"
+#include <IPC/Server.h>
+#include <IPC/Policies/ErrorHandler.h>
+#include "Client.h"
+#include "DefaultTraits.h"
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+
+namespace IPC
+{
+namespace Bond
+{
+    // Serves upstream requests by forwarding the raw buffers to a downstream Client without decoding them.
+    // Request and Response only describe the payload, blobs are copied once per hop. When the request cannot
+    // be forwarded (no downstream client or it fails to send) the error handler is invoked and the upstream
+    // transaction is left to time out.
+    template <typename Request, typename Response, typename Traits = DefaultTraits>
+    class ProxyServer
+        : public detail::BufferComponent<IPC::Server, Request, Response, Traits>,
+          public detail::BufferPoolHolder<typename Traits::BufferPool>
+    {
+        static_assert(!std::is_void<Response>::value, "One-way proxies are not supported.");
+
+        using Base = detail::BufferComponent<IPC::Server, Request, Response, Traits>;
+
+    protected:
+        using BufferPoolHolder = detail::BufferPoolHolder<typename Traits::BufferPool>;
+
+    public:
+        template <typename ClientAccessor, typename CloseHandler, typename ErrorHandler = typename Traits::ErrorHandler>
+        ProxyServer(
+            BufferPoolHolder pools,
+            std::unique_ptr<typename Base::Connection> connection,
+            ClientAccessor&& clientAccessor,
+            CloseHandler&& closeHandler,
+            ErrorHandler&& errorHandler = {})
+            : Base{
+                std::move(connection),
+                [outputPool = pools.GetOutputPool(),
+                 clientAccessor = std::forward<ClientAccessor>(clientAccessor),
+                 errorHandler = std::forward<ErrorHandler>(errorHandler)](typename Traits::BufferPool::ConstBuffer&& request, auto&& callback) mutable
+                {
+                    try
+                    {
+                        auto&& client = clientAccessor();
+
+                        if (!client)
+                        {
+                            throw std::runtime_error{ "No downstream client to forward the request to." };
+                        }
+
+                        auto resolved = outputPool->ResolveReferences(request);
+
+                        client->Forward(
+                            resolved ? resolved : request,
+                            [outputPool, callback = std::forward<decltype(callback)>(callback)](typename Traits::BufferPool::ConstBuffer&& response) mutable
+                            {
+                                callback(CopyBuffer(response, *outputPool));
+                            });
+                    }
+                    catch (...)
+                    {
+                        errorHandler(std::current_exception());
+                    }
+                },
+                std::forward<CloseHandler>(closeHandler) },
+              BufferPoolHolder{ std::move(pools) }
+        {}
+    };
+
+
+    template <typename Request, typename Response, typename Traits = DefaultTraits, typename ClientAccessor, typename CloseHandler,
+        typename ErrorHandler = typename Traits::ErrorHandler>
+    auto MakeProxyServer(
+        std::unique_ptr<typename ProxyServer<Request, Response, Traits>::Connection> connection,
+        ClientAccessor&& clientAccessor,
+        CloseHandler&& closeHandler,
+        ErrorHandler&& errorHandler = {})
+    {
+        auto pools = detail::MakeBufferPoolHolder<typename Traits::BufferPool>(*connection, Traits::EnablePeerReferences);
+
+        return std::make_unique<ProxyServer<Request, Response, Traits>>(
+            std::move(pools),
+            std::move(connection),
+            std::forward<ClientAccessor>(clientAccessor),
+            std::forward<CloseHandler>(closeHandler),
+            std::forward<ErrorHandler>(errorHandler));
+    }
+
+} // Bond
+} // IPC
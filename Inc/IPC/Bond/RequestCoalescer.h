@@ -0,0 +1,181 @@
+#pragma once
+
+#include "BufferPoolFwd.h"
+#include "detail/BufferKey.h"
+#include "InplaceFunction.h"
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+namespace IPC
+{
+namespace Bond
+{
+    class NoRequestCoalescer
+    {
+    public:
+        template <typename Buffer, typename Callback, typename Send>
+        void operator()(Buffer&& request, Callback&& callback, Send&& send)
+        {
+            std::forward<Send>(send)(std::forward<Buffer>(request), std::forward<Callback>(callback));
+        }
+    };
+
+
+    struct RequestBytesKey
+    {
+        template <typename Buffer>
+        std::string operator()(const Buffer& request) const
+        {
+            return detail::MakeBufferKey(request);
+        }
+    };
+
+
+    // Sends a single request for identical requests that are in flight at the same time and passes
+    // the response buffer to every caller, each of which deserializes it independently. Transaction
+    // arguments (e.g. timeouts) of the first caller apply to the whole group. An empty key disables
+    // coalescing for a given request.
+    template <typename BufferPool = DefaultBufferPool, typename KeyExtractor = RequestBytesKey>
+    class InFlightRequestCoalescer
+    {
+        using ConstBuffer = typename BufferPool::ConstBuffer;
+        using Waiter = InplaceFunction<void(ConstBuffer&&)>;
+
+        struct Group
+        {
+            std::vector<Waiter> m_waiters;
+        };
+
+        struct State
+        {
+            std::mutex m_lock;
+            std::unordered_map<std::string, std::shared_ptr<Group>> m_groups;
+        };
+
+        class Completion
+        {
+        public:
+            Completion(std::shared_ptr<State> state, std::string key, std::shared_ptr<Group> group)
+                : m_state{ std::move(state) },
+                  m_key{ std::move(key) },
+                  m_group{ std::move(group) }
+            {}
+
+            Completion(Completion&& other) = default;
+
+            ~Completion()
+            {
+                if (m_group)
+                {
+                    // Transaction was dropped without a response, the next request is sent anew.
+                    Detach();
+                }
+            }
+
+            void operator()(ConstBuffer&& response)
+            {
+                if (!m_group)
+                {
+                    return;
+                }
+
+                auto group = Detach();
+                std::exception_ptr error;
+
+                for (auto& waiter : group->m_waiters)
+                {
+                    try
+                    {
+                        waiter(ConstBuffer{ response });
+                    }
+                    catch (...)
+                    {
+                        // Keep going, the other callers must still receive the response.
+                        if (!error)
+                        {
+                            error = std::current_exception();
+                        }
+                    }
+                }
+
+                if (error)
+                {
+                    std::rethrow_exception(error);
+                }
+            }
+
+        private:
+            std::shared_ptr<Group> Detach()
+            {
+                std::lock_guard<std::mutex> guard{ m_state->m_lock };
+
+                auto it = m_state->m_groups.find(m_key);
+                if (it != m_state->m_groups.end() && it->second == m_group)
+                {
+                    m_state->m_groups.erase(it);
+                }
+
+                return std::move(m_group);
+            }
+
+            std::shared_ptr<State> m_state;
+            std::string m_key;
+            std::shared_ptr<Group> m_group;
+        };
+
+    public:
+        InFlightRequestCoalescer() = default;
+
+        explicit InFlightRequestCoalescer(KeyExtractor keyExtractor)
+            : m_keyExtractor{ std::move(keyExtractor) }
+        {}
+
+        template <typename Callback, typename Send>
+        void operator()(ConstBuffer&& request, Callback&& callback, Send&& send)
+        {
+            auto key = m_keyExtractor(static_cast<const ConstBuffer&>(request));
+
+            if (key.empty())
+            {
+                std::forward<Send>(send)(std::move(request), std::forward<Callback>(callback));
+                return;
+            }
+
+            Waiter waiter{ std::forward<Callback>(callback) };
+            std::shared_ptr<Group> group;
+            {
+                std::lock_guard<std::mutex> guard{ m_state->m_lock };
+
+                auto& existing = m_state->m_groups[key];
+
+                if (existing)
+                {
+                    existing->m_waiters.push_back(std::move(waiter));
+                    return;
+                }
+
+                existing = group = std::make_shared<Group>();
+                group->m_waiters.push_back(std::move(waiter));
+            }
+
+            std::forward<Send>(send)(std::move(request), Completion{ m_state, std::move(key), std::move(group) });
+        }
+
+        std::size_t GetInFlightCount() const
+        {
+            std::lock_guard<std::mutex> guard{ m_state->m_lock };
+            return m_state->m_groups.size();
+        }
+
+    private:
+        KeyExtractor m_keyExtractor;
+        std::shared_ptr<State> m_state{ std::make_shared<State>() };
+    };
+
+} // Bond
+} // IPC
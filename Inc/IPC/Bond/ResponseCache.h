@@ -0,0 +1,368 @@
+#pragma once
+
+#include "BufferPoolFwd.h"
+#include "detail/BufferKey.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+namespace IPC
+{
+namespace Bond
+{
+    class NoResponseCache
+    {
+    public:
+        struct Token
+        {};
+
+        NoResponseCache MakeStore() const
+        {
+            return *this;
+        }
+
+        template <typename Buffer>
+        bool Find(const Buffer& /*request*/, Token& /*token*/, Buffer& /*response*/) const
+        {
+            return false;
+        }
+
+        template <typename Buffer>
+        void Insert(Token&& /*token*/, const Buffer& /*response*/) const
+        {}
+    };
+
+
+    // Keeps serialized responses per connection, so repeated requests are answered with the same
+    // refcounted buffer without invoking the handler. All stores share the configuration and invalidation,
+    // but each enforces the bounds on its own entries. Keys count towards maxBytes, the default one being
+    // a copy of the whole request. Requests carrying peer references are not cached.
+    template <typename BufferPool = DefaultBufferPool>
+    class LruResponseCache
+    {
+        using ConstBuffer = typename BufferPool::ConstBuffer;
+        using Clock = std::chrono::steady_clock;
+
+        class State;
+        struct Registry;
+
+    public:
+        using Key = std::string;
+        using KeyExtractor = std::function<Key(const ConstBuffer& request)>;
+
+        class Store
+        {
+        public:
+            class Token
+            {
+            private:
+                friend State;
+
+                Key m_key;
+                std::uint64_t m_generation{ 0 };
+            };
+
+            Store() = default;
+
+            bool Find(const ConstBuffer& request, Token& token, ConstBuffer& response) const
+            {
+                return m_state && m_state->Find(request, token, response);
+            }
+
+            void Insert(Token&& token, const ConstBuffer& response) const
+            {
+                if (m_state)
+                {
+                    m_state->Insert(std::move(token), response);
+                }
+            }
+
+            void Invalidate(const Key& key) const
+            {
+                if (m_state)
+                {
+                    m_state->Invalidate(key);
+                }
+            }
+
+            void Clear() const
+            {
+                if (m_state)
+                {
+                    m_state->Clear();
+                }
+            }
+
+            std::size_t GetCount() const
+            {
+                return m_state ? m_state->GetCount() : 0;
+            }
+
+        private:
+            friend LruResponseCache;
+
+            explicit Store(std::shared_ptr<State> state)
+                : m_state{ std::move(state) }
+            {}
+
+            std::shared_ptr<State> m_state;
+        };
+
+
+        LruResponseCache() = default;
+
+        // The maxEntries and maxBytes bounds apply to each store (i.e. connection) separately, so the total
+        // footprint grows with the number of connections. A zero maxEntries, maxBytes or ttl means that the
+        // corresponding bound is not enforced.
+        // The key extractor may return an empty key to bypass the cache for a given request.
+        LruResponseCache(std::size_t maxEntries, std::size_t maxBytes, Clock::duration ttl = {}, KeyExtractor keyExtractor = {})
+            : m_registry{ std::make_shared<Registry>() }
+        {
+            m_registry->m_maxEntries = maxEntries;
+            m_registry->m_maxBytes = maxBytes;
+            m_registry->m_ttl = ttl;
+            m_registry->m_keyExtractor = keyExtractor ? std::move(keyExtractor) : KeyExtractor{ &MakeKey };
+        }
+
+        Store MakeStore() const
+        {
+            if (!m_registry)
+            {
+                return{};
+            }
+
+            auto state = std::make_shared<State>(m_registry);
+
+            std::lock_guard<std::mutex> guard{ m_registry->m_lock };
+
+            auto& stores = m_registry->m_stores;
+            stores.erase(
+                std::remove_if(stores.begin(), stores.end(), [](const std::weak_ptr<State>& store) { return store.expired(); }),
+                stores.end());
+
+            stores.push_back(state);
+
+            return Store{ std::move(state) };
+        }
+
+        // Drops the entry with the given key from every store created by this cache.
+        void Invalidate(const Key& key) const
+        {
+            ForEachStore([&](State& state) { state.Invalidate(key); });
+        }
+
+        // Drops all entries from every store created by this cache.
+        void Clear() const
+        {
+            ForEachStore([](State& state) { state.Clear(); });
+        }
+
+        static Key MakeKey(const ConstBuffer& request)
+        {
+            return detail::MakeBufferKey(request);
+        }
+
+    private:
+        struct Registry
+        {
+            std::size_t m_maxEntries{ 0 };
+            std::size_t m_maxBytes{ 0 };
+            Clock::duration m_ttl{};
+            KeyExtractor m_keyExtractor;
+
+            std::mutex m_lock;
+            std::vector<std::weak_ptr<State>> m_stores;
+        };
+
+
+        class State
+        {
+        public:
+            explicit State(std::shared_ptr<Registry> registry)
+                : m_registry{ std::move(registry) }
+            {}
+
+            bool Find(const ConstBuffer& request, typename Store::Token& token, ConstBuffer& response)
+            {
+                // Peer references are offsets of pinned blobs which get reused, so they do not identify the content.
+                if (request && std::any_of(request.begin(), request.end(), [](const auto& blob) { return blob && blob.IsReference(); }))
+                {
+                    return false;
+                }
+
+                token.m_key = m_registry->m_keyExtractor(request);
+
+                if (token.m_key.empty())
+                {
+                    return false;
+                }
+
+                std::lock_guard<std::mutex> guard{ m_lock };
+
+                token.m_generation = m_generation;
+
+                auto it = m_index.find(token.m_key);
+                if (it == m_index.end())
+                {
+                    return false;
+                }
+
+                if (m_registry->m_ttl != Clock::duration::zero() && Clock::now() >= it->second->m_expiration)
+                {
+                    Erase(it->second);
+                    return false;
+                }
+
+                m_entries.splice(m_entries.begin(), m_entries, it->second);
+                response = it->second->m_response;
+
+                return true;
+            }
+
+            void Insert(typename Store::Token&& token, const ConstBuffer& response)
+            {
+                const auto& registry = *m_registry;
+                auto size = (response ? response.size() : 0) + token.m_key.size();
+
+                if (token.m_key.empty() || (registry.m_maxBytes != 0 && size > registry.m_maxBytes))
+                {
+                    return;
+                }
+
+                std::lock_guard<std::mutex> guard{ m_lock };
+
+                if (token.m_generation != m_generation)
+                {
+                    return;     // Invalidated while the handler was running.
+                }
+
+                auto it = m_index.find(token.m_key);
+                if (it != m_index.end())
+                {
+                    Erase(it->second);
+                }
+
+                // The key is kept once, entries refer to it in the index.
+                auto index = m_index.emplace(std::move(token.m_key), Iterator{}).first;
+
+                try
+                {
+                    m_entries.push_front(Entry{ &index->first, response, size, Clock::now() + registry.m_ttl });
+                }
+                catch (...)
+                {
+                    m_index.erase(index);
+                    throw;
+                }
+
+                index->second = m_entries.begin();
+                m_size += size;
+
+                while ((registry.m_maxEntries != 0 && m_entries.size() > registry.m_maxEntries)
+                    || (registry.m_maxBytes != 0 && m_size > registry.m_maxBytes))
+                {
+                    Erase(std::prev(m_entries.end()));
+                }
+            }
+
+            void Invalidate(const Key& key)
+            {
+                std::lock_guard<std::mutex> guard{ m_lock };
+
+                ++m_generation;
+
+                auto it = m_index.find(key);
+                if (it != m_index.end())
+                {
+                    Erase(it->second);
+                }
+            }
+
+            void Clear()
+            {
+                std::lock_guard<std::mutex> guard{ m_lock };
+
+                ++m_generation;
+
+                m_index.clear();
+                m_entries.clear();
+                m_size = 0;
+            }
+
+            std::size_t GetCount() const
+            {
+                std::lock_guard<std::mutex> guard{ m_lock };
+                return m_entries.size();
+            }
+
+        private:
+            struct Entry
+            {
+                const Key* m_key;       // Owned by m_index.
+                ConstBuffer m_response;
+                std::size_t m_size;
+                Clock::time_point m_expiration;
+            };
+
+            using Iterator = typename std::list<Entry>::iterator;
+
+            void Erase(Iterator it)
+            {
+                m_size -= it->m_size;
+
+                auto index = m_index.find(*it->m_key);
+                m_entries.erase(it);
+                m_index.erase(index);
+            }
+
+            std::shared_ptr<Registry> m_registry;
+            mutable std::mutex m_lock;
+            std::list<Entry> m_entries;
+            std::unordered_map<Key, Iterator> m_index;
+            std::size_t m_size{ 0 };
+            std::uint64_t m_generation{ 0 };
+        };
+
+
+        template <typename Function>
+        void ForEachStore(Function&& func) const
+        {
+            if (!m_registry)
+            {
+                return;
+            }
+
+            std::vector<std::shared_ptr<State>> stores;
+            {
+                std::lock_guard<std::mutex> guard{ m_registry->m_lock };
+
+                for (const auto& store : m_registry->m_stores)
+                {
+                    if (auto state = store.lock())
+                    {
+                        stores.push_back(std::move(state));
+                    }
+                }
+            }
+
+            for (const auto& state : stores)
+            {
+                func(*state);
+            }
+        }
+
+        std::shared_ptr<Registry> m_registry;
+    };
+
+} // Bond
+} // IPC
@@ -3,9 +3,20 @@
 #include "OutputBuffer.h"
 #include "InputBuffer.h"
 #include "BufferPool.h"
+#include "StaticCodec.h"
+#include "SharedObject.h"
+#include "FlatCodec.h"
+#include "detail/BlobHolder.h"
+#include "detail/ProtocolNegotiation.h"
 #include <bond/core/bond.h>
+#include <bond/protocol/compact_binary.h>
+#include <bond/protocol/fast_binary.h>
+#include <bond/protocol/simple_binary.h>
+#include <bond/protocol/simple_json_writer.h>
 #include <memory>
 #include <future>
+#include <stdexcept>
+#include <type_traits>
 
 
 namespace IPC
@@ -20,59 +31,131 @@ namespace Bond
             bond::SimpleJsonReader<DefaultInputBuffer>> {};
 
 
+    namespace detail
+    {
+        template <typename T>
+        struct IsBonded : std::false_type
+        {};
+
+        template <typename T, typename Reader>
+        struct IsBonded<bond::bonded<T, Reader>> : std::true_type
+        {};
+
+        // Readers work on a borrowed view of the input, which outlives them, unless the
+        // value keeps the reader itself.
+        template <typename T, typename ConstBuffer>
+        InputBuffer<ConstBuffer> BorrowInput(const InputBuffer<ConstBuffer>& input)
+        {
+            return IsBonded<T>::value ? input : input.Borrow();
+        }
+
+    } // detail
+
     template <template <typename> typename Writer, typename Protocols = DefaultProtocols, typename BufferPool, typename T>
-    typename BufferPool::ConstBuffer Serialize(std::shared_ptr<BufferPool> pool, const T& value, std::size_t minBlobSize = 0)
+    typename BufferPool::ConstBuffer Serialize(std::shared_ptr<BufferPool> pool, const T& value, std::size_t minBlobSize = 0, std::size_t alignedBlobSize = 0)
     {
-        OutputBuffer<BufferPool> output{ std::move(pool), minBlobSize };
+        OutputBuffer<BufferPool> output{ std::move(pool), minBlobSize, alignedBlobSize };
         Writer<decltype(output)> writer{ output };
         bond::Serialize<Protocols>(value, writer);
         return std::move(output).GetBuffer();
     }
 
     template <typename Protocols = DefaultProtocols, typename BufferPool, typename T>
-    typename BufferPool::ConstBuffer Serialize(bond::ProtocolType protocol, std::shared_ptr<BufferPool> pool, const T& value, std::size_t minBlobSize = 0)
+    typename BufferPool::ConstBuffer Serialize(bond::ProtocolType protocol, std::shared_ptr<BufferPool> pool, const T& value, std::size_t minBlobSize = 0, std::size_t alignedBlobSize = 0)
     {
-        OutputBuffer<BufferPool> output{ std::move(pool), minBlobSize };
+        OutputBuffer<BufferPool> output{ std::move(pool), minBlobSize, alignedBlobSize };
         bond::Apply<bond::Serializer, Protocols>(value, output, static_cast<std::uint16_t>(protocol));
         return std::move(output).GetBuffer();
     }
 
     template <template <typename> typename Reader, typename Protocols = DefaultProtocols, typename ConstBuffer, typename T>
-    void Deserialize(ConstBuffer&& buffer, T& value, std::shared_ptr<SharedMemory> memory)
+    void Deserialize(ConstBuffer&& buffer, T& value, std::shared_ptr<SharedMemory> memory, std::shared_ptr<SharedMemory> otherMemory = {})
     {
-        InputBuffer<std::decay_t<ConstBuffer>> input{ std::forward<ConstBuffer>(buffer), std::move(memory) };
-        Reader<decltype(input)> reader{ std::move(input) };
+        InputBuffer<std::decay_t<ConstBuffer>> input{ std::forward<ConstBuffer>(buffer), std::move(memory), std::move(otherMemory) };
+        Reader<decltype(input)> reader{ detail::BorrowInput<T>(input) };
         bond::Deserialize<Protocols>(reader, value);
     }
 
     template <typename Protocols = DefaultProtocols, typename ConstBuffer, typename T>
-    void Deserialize(bond::ProtocolType protocol, ConstBuffer&& buffer, T& value, std::shared_ptr<SharedMemory> memory)
+    void Deserialize(bond::ProtocolType protocol, ConstBuffer&& buffer, T& value, std::shared_ptr<SharedMemory> memory, std::shared_ptr<SharedMemory> otherMemory = {})
     {
-        InputBuffer<std::decay_t<ConstBuffer>> input{ std::forward<ConstBuffer>(buffer), std::move(memory) };
-        bond::Apply<T, Protocols>(bond::To<T, Protocols>{ value }, input, static_cast<std::uint16_t>(protocol));
+        InputBuffer<std::decay_t<ConstBuffer>> input{ std::forward<ConstBuffer>(buffer), std::move(memory), std::move(otherMemory) };
+        bond::Apply<T, Protocols>(bond::To<T, Protocols>{ value }, detail::BorrowInput<T>(input), static_cast<std::uint16_t>(protocol));
     }
 
     template <template <typename> typename Writer, typename Protocols = DefaultProtocols, typename BufferPool, typename T>
-    typename BufferPool::ConstBuffer Marshal(std::shared_ptr<BufferPool> pool, const T& value, std::size_t minBlobSize = 0)
+    typename BufferPool::ConstBuffer Marshal(std::shared_ptr<BufferPool> pool, const T& value, std::size_t minBlobSize = 0, std::size_t alignedBlobSize = 0)
     {
-        OutputBuffer<BufferPool> output{ std::move(pool), minBlobSize };
+        OutputBuffer<BufferPool> output{ std::move(pool), minBlobSize, alignedBlobSize };
         Writer<decltype(output)> writer{ output };
         bond::Marshal<Protocols>(value, writer);
         return std::move(output).GetBuffer();
     }
 
     template <typename Protocols = DefaultProtocols, typename BufferPool, typename T>
-    typename BufferPool::ConstBuffer Marshal(bond::ProtocolType protocol, std::shared_ptr<BufferPool> pool, const T& value, std::size_t minBlobSize = 0)
+    typename BufferPool::ConstBuffer Marshal(bond::ProtocolType protocol, std::shared_ptr<BufferPool> pool, const T& value, std::size_t minBlobSize = 0, std::size_t alignedBlobSize = 0)
     {
-        OutputBuffer<BufferPool> output{ std::move(pool), minBlobSize };
+        OutputBuffer<BufferPool> output{ std::move(pool), minBlobSize, alignedBlobSize };
         bond::Apply<bond::Marshaler, Protocols>(value, output, static_cast<std::uint16_t>(protocol));
         return std::move(output).GetBuffer();
     }
 
     template <typename Protocols = DefaultProtocols, typename ConstBuffer, typename T>
-    void Unmarshal(ConstBuffer&& buffer, T& value, std::shared_ptr<SharedMemory> memory)
+    void Unmarshal(ConstBuffer&& buffer, T& value, std::shared_ptr<SharedMemory> memory, std::shared_ptr<SharedMemory> otherMemory = {})
+    {
+        InputBuffer<std::decay_t<ConstBuffer>> input{ std::forward<ConstBuffer>(buffer), std::move(memory), std::move(otherMemory) };
+        bond::Unmarshal<Protocols>(detail::BorrowInput<T>(input), value);
+    }
+
+    namespace detail
+    {
+        template <typename T, typename Protocols, template <typename...> typename Writer, typename Input, typename Output>
+        void Transcode(bond::ProtocolType fromProtocol, Input& input, Output& output)
+        {
+            Writer<Output> writer{ output };
+            bond::Apply<T, Protocols>(bond::Serializer<Writer<Output>, Protocols>{ writer }, input, static_cast<std::uint16_t>(fromProtocol));
+        }
+
+    } // detail
+
+    // Converts a payload of T serialized with fromProtocol to toProtocol. Values are streamed from the input
+    // to the output buffer guided by the schema of T, no instance of T is constructed.
+    template <typename T, typename Protocols = DefaultProtocols, typename ConstBuffer, typename BufferPool>
+    typename BufferPool::ConstBuffer Transcode(
+        bond::ProtocolType fromProtocol,
+        ConstBuffer&& buffer,
+        bond::ProtocolType toProtocol,
+        std::shared_ptr<BufferPool> pool,
+        std::shared_ptr<SharedMemory> memory,
+        std::size_t minBlobSize = 0)
     {
-        bond::Unmarshal<Protocols>(InputBuffer<std::decay_t<ConstBuffer>>{ std::forward<ConstBuffer>(buffer), std::move(memory) }, value);
+        InputBuffer<std::decay_t<ConstBuffer>> input{ std::forward<ConstBuffer>(buffer), std::move(memory) };
+        auto view = input.Borrow();
+        OutputBuffer<BufferPool> output{ std::move(pool), minBlobSize };
+
+        switch (toProtocol)
+        {
+        case bond::ProtocolType::COMPACT_PROTOCOL:
+            detail::Transcode<T, Protocols, bond::CompactBinaryWriter>(fromProtocol, view, output);
+            break;
+
+        case bond::ProtocolType::FAST_PROTOCOL:
+            detail::Transcode<T, Protocols, bond::FastBinaryWriter>(fromProtocol, view, output);
+            break;
+
+        case bond::ProtocolType::SIMPLE_PROTOCOL:
+            detail::Transcode<T, Protocols, bond::SimpleBinaryWriter>(fromProtocol, view, output);
+            break;
+
+        case bond::ProtocolType::SIMPLE_JSON_PROTOCOL:
+            detail::Transcode<T, Protocols, bond::SimpleJsonWriter>(fromProtocol, view, output);
+            break;
+
+        default:
+            throw std::invalid_argument{ "Unsupported target protocol." };
+        }
+
+        return std::move(output).GetBuffer();
     }
 
 
@@ -82,72 +165,221 @@ namespace Bond
     public:
         using Protocols = ProtocolsT;
 
-        Serializer(bond::ProtocolType protocol, bool marshal, std::shared_ptr<BufferPool> outputPool, std::shared_ptr<SharedMemory> inputMemory, std::size_t minBlobSize = 0)
-            : m_outputPool{ std::move(outputPool) },
-              m_inputMemory{ std::move(inputMemory) },
-              m_protocol{ protocol },
-              m_marshal{ marshal },
-              m_minBlobSize{ minBlobSize }
+        Serializer(
+            bond::ProtocolType protocol,
+            bool marshal,
+            std::shared_ptr<BufferPool> outputPool,
+            std::shared_ptr<SharedMemory> inputMemory,
+            std::size_t minBlobSize = 0,
+            std::size_t alignedBlobSize = 0)
+            : m_state{ std::make_shared<State>(std::move(outputPool), std::move(inputMemory), protocol, marshal, minBlobSize, alignedBlobSize) }
         {}
 
         bond::ProtocolType GetProtocolType() const
         {
-            return m_protocol;
+            return m_state->m_protocol;
         }
 
         bool IsMarshaled() const
         {
-            return m_marshal;
+            return m_state->m_marshal;
+        }
+
+        // Lets marshaled messages omit the header once both ends of the connection agree on the protocol.
+        // All copies share the outcome, it must be called before the serializer is used by other threads.
+        void Negotiate()
+        {
+            if (m_state->m_marshal && !m_state->m_negotiation)
+            {
+                m_state->m_negotiation = std::make_unique<detail::ProtocolNegotiation>(m_state->m_protocol, m_state->m_inputMemory, m_state->m_outputPool->GetMemory());
+            }
+        }
+
+        // Makes both ends keep exchanging marshaled messages, see detail::ProtocolNegotiation::DisableHeaderless.
+        bool DisableHeaderless()
+        {
+            return !m_state->m_negotiation || m_state->m_negotiation->DisableHeaderless();
         }
 
         template <typename T>
         typename BufferPool::ConstBuffer Serialize(const T& value)
         {
-            return m_marshal
-                ? Bond::Marshal<Protocols>(m_protocol, m_outputPool, value, m_minBlobSize)
-                : Bond::Serialize<Protocols>(m_protocol, m_outputPool, value, m_minBlobSize);
+            return Serialize(value, EnableStaticCodec<T>{});
         }
 
         template <typename T>
         void Deserialize(typename BufferPool::ConstBuffer&& buffer, T& value)
         {
-            m_marshal
-                ? Bond::Unmarshal<Protocols>(std::move(buffer), value, m_inputMemory)
-                : Bond::Deserialize<Protocols>(m_protocol, std::move(buffer), value, m_inputMemory);
+            if (auto resolved = m_state->m_outputPool->ResolveReferences(buffer))
+            {
+                // Peer referenced blobs residing in our memory, the rest of the message is still in the input memory.
+                Deserialize(std::move(resolved), value, m_state->m_outputPool->GetMemory(), EnableStaticCodec<T>{});
+            }
+            else
+            {
+                Deserialize(std::move(buffer), value, {}, EnableStaticCodec<T>{});
+            }
+        }
+
+        // Shared objects are passed by reference, objects constructed in other memory are copied as is.
+        template <typename T>
+        typename BufferPool::ConstBuffer Serialize(const SharedObject<T, BufferPool>& value)
+        {
+            return CopyBuffer(value.GetBuffer(), *m_state->m_outputPool);
+        }
+
+        template <typename T>
+        void Deserialize(typename BufferPool::ConstBuffer&& buffer, SharedObject<T, BufferPool>& value)
+        {
+            value = SharedObject<T, BufferPool>{ std::move(buffer) };
+        }
+
+        // Flat objects are read in place by the receiver, so they are passed through as is as well.
+        template <typename T>
+        typename BufferPool::ConstBuffer Serialize(const FlatObject<T, BufferPool>& value)
+        {
+            return CopyBuffer(value.GetBuffer(), *m_state->m_outputPool);
+        }
+
+        template <typename T>
+        void Deserialize(typename BufferPool::ConstBuffer&& buffer, FlatObject<T, BufferPool>& value)
+        {
+            value = FlatObject<T, BufferPool>{ std::move(buffer) };
         }
 
+        // The shared state of the future is recycled, so no heap allocation is made after warm-up.
         template <typename T>
         std::future<T> Deserialize(typename BufferPool::ConstBuffer buffer)
         {
-            std::packaged_task<T()> task{
-                [&]
-                {
-                    T value;
-                    Deserialize(std::move(buffer), value);
-                    return value;
-                } };
+            std::promise<T> promise{ std::allocator_arg, detail::PooledAllocator<T>{} };
 
-            task();
+            try
+            {
+                T value;
+                Deserialize(std::move(buffer), value);
+                promise.set_value(std::move(value));
+            }
+            catch (...)
+            {
+                promise.set_exception(std::current_exception());
+            }
 
-            return task.get_future();
+            return promise.get_future();
         }
 
         const std::shared_ptr<BufferPool>& GetOutputBufferPool() const
         {
-            return m_outputPool;
+            return m_state->m_outputPool;
         }
 
         const std::shared_ptr<SharedMemory>& GetInputMemory() const
         {
-            return m_inputMemory;
+            return m_state->m_inputMemory;
         }
 
     private:
-        std::shared_ptr<BufferPool> m_outputPool;
-        std::shared_ptr<SharedMemory> m_inputMemory;
-        bond::ProtocolType m_protocol;
-        bool m_marshal;
-        std::size_t m_minBlobSize;
+        template <typename T>
+        typename BufferPool::ConstBuffer Serialize(const T& value, std::false_type /*staticCodec*/)
+        {
+            return IsOutputMarshaled()
+                ? Bond::Marshal<Protocols>(m_state->m_protocol, m_state->m_outputPool, value, m_state->m_minBlobSize, m_state->m_alignedBlobSize)
+                : Bond::Serialize<Protocols>(m_state->m_protocol, m_state->m_outputPool, value, m_state->m_minBlobSize, m_state->m_alignedBlobSize);
+        }
+
+        template <typename T>
+        typename BufferPool::ConstBuffer Serialize(const T& value, std::true_type /*staticCodec*/)
+        {
+            switch (m_state->m_protocol)
+            {
+            case bond::ProtocolType::COMPACT_PROTOCOL:
+                return StaticSerialize<StaticCompactBinary>(m_state->m_outputPool, value, IsOutputMarshaled(), m_state->m_minBlobSize, m_state->m_alignedBlobSize);
+
+            case bond::ProtocolType::FAST_PROTOCOL:
+                return StaticSerialize<StaticFastBinary>(m_state->m_outputPool, value, IsOutputMarshaled(), m_state->m_minBlobSize, m_state->m_alignedBlobSize);
+
+            default:
+                return Serialize(value, std::false_type{});
+            }
+        }
+
+        // Blobs residing in otherMemory are linked from there, the rest from the input memory.
+        template <typename T>
+        void Deserialize(typename BufferPool::ConstBuffer&& buffer, T& value, const std::shared_ptr<SharedMemory>& otherMemory, std::false_type /*staticCodec*/)
+        {
+            const auto& memory = m_state->m_inputMemory;
+
+            IsInputMarshaled()
+                ? Bond::Unmarshal<Protocols>(std::move(buffer), value, memory, otherMemory)
+                : Bond::Deserialize<Protocols>(m_state->m_protocol, std::move(buffer), value, memory, otherMemory);
+        }
+
+        template <typename T>
+        void Deserialize(typename BufferPool::ConstBuffer&& buffer, T& value, const std::shared_ptr<SharedMemory>& otherMemory, std::true_type /*staticCodec*/)
+        {
+            const auto& memory = m_state->m_inputMemory;
+
+            bool isDecoded = false;
+
+            switch (m_state->m_protocol)
+            {
+            case bond::ProtocolType::COMPACT_PROTOCOL:
+                isDecoded = StaticDeserialize<StaticCompactBinary>(buffer, value, IsInputMarshaled(), memory, otherMemory);
+                break;
+
+            case bond::ProtocolType::FAST_PROTOCOL:
+                isDecoded = StaticDeserialize<StaticFastBinary>(buffer, value, IsInputMarshaled(), memory, otherMemory);
+                break;
+
+            default:
+                break;
+            }
+
+            if (!isDecoded)
+            {
+                // Payload was produced by a different schema version or protocol, use bond.
+                value = T{};
+                Deserialize(std::move(buffer), value, otherMemory, std::false_type{});
+            }
+        }
+
+        bool IsOutputMarshaled() const
+        {
+            return m_state->m_negotiation ? m_state->m_negotiation->IsOutputMarshaled() : m_state->m_marshal;
+        }
+
+        bool IsInputMarshaled() const
+        {
+            return m_state->m_negotiation ? m_state->m_negotiation->IsInputMarshaled() : m_state->m_marshal;
+        }
+
+        // Shared by copies, so capturing a serializer per request costs a single reference count update.
+        struct State
+        {
+            State(
+                std::shared_ptr<BufferPool> outputPool,
+                std::shared_ptr<SharedMemory> inputMemory,
+                bond::ProtocolType protocol,
+                bool marshal,
+                std::size_t minBlobSize,
+                std::size_t alignedBlobSize)
+                : m_outputPool{ std::move(outputPool) },
+                  m_inputMemory{ std::move(inputMemory) },
+                  m_protocol{ protocol },
+                  m_marshal{ marshal },
+                  m_minBlobSize{ minBlobSize },
+                  m_alignedBlobSize{ alignedBlobSize }
+            {}
+
+            std::shared_ptr<BufferPool> m_outputPool;
+            std::shared_ptr<SharedMemory> m_inputMemory;
+            bond::ProtocolType m_protocol;
+            bool m_marshal;
+            std::size_t m_minBlobSize;
+            std::size_t m_alignedBlobSize;
+            std::unique_ptr<detail::ProtocolNegotiation> m_negotiation;
+        };
+
+        std::shared_ptr<State> m_state;
     };
 
 
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "detail/ComponentBase.h"
+#include "detail/HandlerTraits.h"
+#include "detail/ProtocolNegotiation.h"
 #include <IPC/Server.h>
 #include "DefaultTraits.h"
 #include <bond/core/bond_const_enum.h>
@@ -17,22 +19,96 @@ namespace Bond
 
     public:
         template <typename Handler, typename CloseHandler>
-        Server(typename Base::BufferPoolHolder pools, typename Base::Serializer serializer, std::unique_ptr<typename Base::Connection> connection, Handler&& handler, CloseHandler&& closeHandler)
+        Server(
+            typename Base::BufferPoolHolder pools,
+            typename Base::Serializer serializer,
+            std::unique_ptr<typename Base::Connection> connection,
+            Handler&& handler,
+            CloseHandler&& closeHandler,
+            typename Traits::DeserializationScheduler scheduler = {},
+            typename Traits::ResponseCache cache = {})
             : Base{
                 std::move(pools),
                 serializer,
                 std::move(connection),
-                [serializer, handler = std::forward<Handler>(handler)](typename Traits::BufferPool::ConstBuffer&& buffer, auto&& callback) mutable
+                [serializer,
+                 handler = MakeHandler(std::forward<Handler>(handler)),
+                 dispatcher = scheduler.MakeDispatcher(),
+                 store = cache.MakeStore(),
+                 objects = ObjectPool{}](typename Traits::BufferPool::ConstBuffer&& buffer, auto&& callback) mutable
                 {
-                    handler(
-                        serializer.template Deserialize<Request>(std::move(buffer)),
-                        [serializer, callback = std::forward<decltype(callback)>(callback)](const Response& response) mutable
+                    dispatcher(
+                        std::move(buffer),
+                        [serializer, handler, store, objects, callback = std::forward<decltype(callback)>(callback)](
+                            typename Traits::BufferPool::ConstBuffer&& buffer) mutable
                         {
-                            callback(serializer.Serialize(response));
+                            // Runs after dispatch, so keying a large request does not stall the delivery thread.
+                            typename ResponseStore::Token token;
+                            typename Traits::BufferPool::ConstBuffer cached;
+
+                            if (store.Find(buffer, token, cached))
+                            {
+                                callback(std::move(cached));
+                                return;
+                            }
+
+                            auto responseCallback = [serializer, store, token = std::move(token), callback = std::move(callback)](const Response& response) mutable
+                            {
+                                auto buffer = serializer.Serialize(response);
+                                store.Insert(std::move(token), buffer);
+                                callback(std::move(buffer));
+                            };
+
+                            Invoke(
+                                serializer,
+                                objects,
+                                *handler,
+                                std::move(buffer),
+                                std::move(responseCallback),
+                                detail::AcceptsFutureWithCallback<std::decay_t<decltype(*handler)>, Request, decltype(responseCallback)>{});
                         });
                 },
                 std::forward<CloseHandler>(closeHandler) }
         {}
+
+    private:
+        using ResponseStore = decltype(std::declval<const typename Traits::ResponseCache&>().MakeStore());
+        using ObjectPool = typename Traits::template ObjectPool<Request>;
+
+        template <typename Handler>
+        static auto MakeHandler(Handler&& handler)
+        {
+            using Adapter = detail::HandlerAdapter<std::decay_t<Handler>, Request, Response, typename Traits::ErrorHandler>;
+            using AdaptedHandler = std::decay_t<decltype(Adapter::Adapt(std::forward<Handler>(handler)))>;
+
+            return std::make_shared<AdaptedHandler>(Adapter::Adapt(std::forward<Handler>(handler)));
+        }
+
+        template <typename Handler, typename Callback>
+        static void Invoke(
+            typename Base::Serializer& serializer,
+            const ObjectPool& /*objects*/,
+            Handler& handler,
+            typename Traits::BufferPool::ConstBuffer&& buffer,
+            Callback&& callback,
+            std::true_type /*acceptsFuture*/)
+        {
+            handler(serializer.template Deserialize<Request>(std::move(buffer)), std::forward<Callback>(callback));
+        }
+
+        template <typename Handler, typename Callback>
+        static void Invoke(
+            typename Base::Serializer& serializer,
+            const ObjectPool& objects,
+            Handler& handler,
+            typename Traits::BufferPool::ConstBuffer&& buffer,
+            Callback&& callback,
+            std::false_type /*acceptsFuture*/)
+        {
+            // Handler must accept both (Request&&, Callback) and (std::exception_ptr, Callback). The request goes back to the pool
+            // once the callback is released, so it may be used until the response is sent.
+            detail::DeserializeAndInvoke<Request>(serializer, objects, std::move(buffer), handler, std::forward<Callback>(callback));
+        }
     };
 
 
@@ -43,15 +119,24 @@ namespace Bond
         CloseHandler&& closeHandler,
         bond::ProtocolType protocol = bond::ProtocolType::COMPACT_PROTOCOL,
         bool marshal = true,
-        std::size_t minBlobSize = 0)
+        std::size_t minBlobSize = 0,
+        typename Traits::DeserializationScheduler scheduler = {},
+        typename Traits::ResponseCache cache = {})
     {
-        auto pools = detail::MakeBufferPoolHolder<typename Traits::BufferPool>(*connection);
+        auto pools = detail::MakeBufferPoolHolder<typename Traits::BufferPool>(*connection, Traits::EnablePeerReferences);
         typename Traits::Serializer serializer{ protocol, marshal, pools.GetOutputPool(), pools.GetInputPool()->GetMemory(), minBlobSize };
+        detail::NegotiateProtocol(serializer);
 
         auto handler = handlerFactory(*connection, pools, serializer);
 
         return std::make_unique<Server<Request, Response, Traits>>(
-            std::move(pools), std::move(serializer), std::move(connection), std::move(handler), std::forward<CloseHandler>(closeHandler));
+            std::move(pools),
+            std::move(serializer),
+            std::move(connection),
+            std::move(handler),
+            std::forward<CloseHandler>(closeHandler),
+            std::move(scheduler),
+            cache);
     }
 
 } // Bond
@@ -0,0 +1,241 @@
+#pragma once
+
+#include "BufferPool.h"
+#include <boost/interprocess/offset_ptr.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+
+
+namespace IPC
+{
+namespace Bond
+{
+    namespace detail
+    {
+    namespace SharedObject
+    {
+        struct Header
+        {
+            static constexpr std::uint32_t Magic = 0x4A424F53; // "SOBJ"
+
+            std::uint32_t m_magic;
+            std::uint32_t m_objectOffset;
+            std::uint64_t m_capacity;
+            std::uint64_t m_used;
+        };
+
+        inline std::size_t Align(std::size_t offset, std::size_t alignment)
+        {
+            return (offset + alignment - 1) / alignment * alignment;
+        }
+
+    } // SharedObject
+    } // detail
+
+
+    // Position independent allocator which carves memory from the blob holding the object, so the whole
+    // object graph is released together with the blob and stays valid when the blob is copied to other memory.
+    template <typename T>
+    class SharedObjectAllocator
+    {
+    public:
+        using value_type = T;
+        using pointer = boost::interprocess::offset_ptr<T>;
+        using const_pointer = boost::interprocess::offset_ptr<const T>;
+        using void_pointer = boost::interprocess::offset_ptr<void>;
+        using const_void_pointer = boost::interprocess::offset_ptr<const void>;
+        using difference_type = std::ptrdiff_t;
+        using size_type = std::size_t;
+
+        template <typename U>
+        struct rebind
+        {
+            using other = SharedObjectAllocator<U>;
+        };
+
+        SharedObjectAllocator() = default;
+
+        SharedObjectAllocator(const SharedObjectAllocator& other) = default;
+
+        template <typename U>
+        SharedObjectAllocator(const SharedObjectAllocator<U>& other) noexcept
+            : m_header{ other.GetHeader() }
+        {}
+
+        SharedObjectAllocator& operator=(const SharedObjectAllocator& other) = default;
+
+        pointer allocate(std::size_t count)
+        {
+            if (!m_header)
+            {
+                throw std::bad_alloc{};
+            }
+
+            auto& header = *m_header;
+            auto offset = detail::SharedObject::Align(static_cast<std::size_t>(header.m_used), alignof(T));
+
+            if (count > (header.m_capacity - offset) / sizeof(T))
+            {
+                throw std::bad_alloc{};
+            }
+
+            header.m_used = offset + count * sizeof(T);
+
+            return pointer{ reinterpret_cast<T*>(reinterpret_cast<char*>(&header) + offset) };
+        }
+
+        void deallocate(pointer /*ptr*/, std::size_t /*count*/) noexcept
+        {}
+
+        detail::SharedObject::Header* GetHeader() const noexcept
+        {
+            return m_header.get();
+        }
+
+        template <typename U>
+        bool operator==(const SharedObjectAllocator<U>& other) const noexcept
+        {
+            return GetHeader() == other.GetHeader();
+        }
+
+        template <typename U>
+        bool operator!=(const SharedObjectAllocator<U>& other) const noexcept
+        {
+            return !(*this == other);
+        }
+
+    private:
+        template <typename U, typename BufferPool>
+        friend class SharedObjectWriter;
+
+        SharedObjectAllocator(detail::SharedObject::Header& header) noexcept
+            : m_header{ &header }
+        {}
+
+        boost::interprocess::offset_ptr<detail::SharedObject::Header> m_header;
+    };
+
+
+    // Read-only view of an object constructed directly in shared memory by SharedObjectWriter.
+    // Serializer passes it through as is, so it can be used as Request or Response of Client and Server.
+    // T must be instantiated with SharedObjectAllocator, use containers supporting offset pointers
+    // (e.g. boost::container) and must not own resources outside of the blob since it is never destroyed.
+    template <typename T, typename BufferPool = DefaultBufferPool>
+    class SharedObject
+    {
+    public:
+        using ConstBuffer = typename BufferPool::ConstBuffer;
+
+        SharedObject() = default;
+
+        explicit SharedObject(ConstBuffer buffer)
+            : m_buffer{ std::move(buffer) }
+        {
+            if (!m_buffer || std::next(m_buffer.begin()) != m_buffer.end())
+            {
+                throw std::invalid_argument{ "Shared object must occupy a single blob." };
+            }
+
+            const auto& blob = *m_buffer.begin();
+
+            if (blob.size() < sizeof(detail::SharedObject::Header)
+                || reinterpret_cast<std::uintptr_t>(blob.data()) % alignof(detail::SharedObject::Header) != 0)
+            {
+                throw std::invalid_argument{ "Invalid shared object." };
+            }
+
+            const auto& header = *reinterpret_cast<const detail::SharedObject::Header*>(blob.data());
+
+            if (header.m_magic != detail::SharedObject::Header::Magic
+                || header.m_capacity != blob.size()
+                || header.m_objectOffset % alignof(T) != 0
+                || header.m_objectOffset + sizeof(T) > blob.size())
+            {
+                throw std::invalid_argument{ "Invalid shared object." };
+            }
+
+            m_object = reinterpret_cast<const T*>(blob.data() + header.m_objectOffset);
+        }
+
+        explicit operator bool() const
+        {
+            return m_object != nullptr;
+        }
+
+        const T& operator*() const
+        {
+            return *m_object;
+        }
+
+        const T* operator->() const
+        {
+            return m_object;
+        }
+
+        const ConstBuffer& GetBuffer() const
+        {
+            return m_buffer;
+        }
+
+    private:
+        ConstBuffer m_buffer;
+        const T* m_object{ nullptr };
+    };
+
+
+    // Constructs T in a single blob of the given capacity, all nested allocations come from the same blob.
+    template <typename T, typename BufferPool = DefaultBufferPool>
+    class SharedObjectWriter
+    {
+    public:
+        SharedObjectWriter(BufferPool& pool, std::size_t capacity)
+        {
+            using detail::SharedObject::Align;
+            using detail::SharedObject::Header;
+
+            auto objectOffset = Align(sizeof(Header), alignof(T));
+
+            if (capacity < objectOffset + sizeof(T) || capacity > (std::numeric_limits<std::uint32_t>::max)())
+            {
+                throw std::invalid_argument{ "Invalid shared object capacity." };
+            }
+
+            auto blob = pool.TakeBlob();
+            blob->resize(capacity, boost::container::default_init);
+
+            auto& header = *new (blob->data()) Header{ Header::Magic, static_cast<std::uint32_t>(objectOffset), capacity, objectOffset + sizeof(T) };
+
+            m_object = new (blob->data() + objectOffset) T(typename T::allocator_type{ header });
+
+            m_buffer = pool.TakeBuffer();
+            m_buffer->push_back(std::move(blob));
+        }
+
+        T& operator*()
+        {
+            return *m_object;
+        }
+
+        T* operator->()
+        {
+            return m_object;
+        }
+
+        SharedObject<T, BufferPool> Finish() &&
+        {
+            return SharedObject<T, BufferPool>{ std::move(m_buffer) };
+        }
+
+    private:
+        typename BufferPool::Buffer m_buffer;
+        T* m_object;
+    };
+
+} // Bond
+} // IPC
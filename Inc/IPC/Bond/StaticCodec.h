@@ -0,0 +1,450 @@
+#pragma once
+
+#include "OutputBuffer.h"
+#include "InputBuffer.h"
+#include "detail/Schema.h"
+#include <bond/core/bond_const_enum.h>
+#include <bond/core/reflection.h>
+#include <bond/core/traits.h>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+
+namespace IPC
+{
+namespace Bond
+{
+    // Specialize as std::true_type to let Serializer use straight-line Compact/Fast code for T.
+    // Only flat schemas are supported: no base struct and fields of arithmetic, enum or string types.
+    template <typename T>
+    struct EnableStaticCodec : std::false_type
+    {};
+
+
+    namespace detail
+    {
+    namespace StaticCodec
+    {
+        template <typename T, typename Enable = void>
+        struct DataType;
+
+        template <bond::BondDataType Type>
+        using DataTypeOf = std::integral_constant<bond::BondDataType, Type>;
+
+        template <> struct DataType<bool> : DataTypeOf<bond::BondDataType::BT_BOOL> {};
+        template <> struct DataType<std::uint8_t> : DataTypeOf<bond::BondDataType::BT_UINT8> {};
+        template <> struct DataType<std::uint16_t> : DataTypeOf<bond::BondDataType::BT_UINT16> {};
+        template <> struct DataType<std::uint32_t> : DataTypeOf<bond::BondDataType::BT_UINT32> {};
+        template <> struct DataType<std::uint64_t> : DataTypeOf<bond::BondDataType::BT_UINT64> {};
+        template <> struct DataType<std::int8_t> : DataTypeOf<bond::BondDataType::BT_INT8> {};
+        template <> struct DataType<std::int16_t> : DataTypeOf<bond::BondDataType::BT_INT16> {};
+        template <> struct DataType<std::int32_t> : DataTypeOf<bond::BondDataType::BT_INT32> {};
+        template <> struct DataType<std::int64_t> : DataTypeOf<bond::BondDataType::BT_INT64> {};
+        template <> struct DataType<float> : DataTypeOf<bond::BondDataType::BT_FLOAT> {};
+        template <> struct DataType<double> : DataTypeOf<bond::BondDataType::BT_DOUBLE> {};
+        template <> struct DataType<std::string> : DataTypeOf<bond::BondDataType::BT_STRING> {};
+
+        template <typename T>
+        struct DataType<T, std::enable_if_t<std::is_enum<T>::value>> : DataTypeOf<bond::BondDataType::BT_INT32> {};
+
+        template <typename T>
+        struct DataType<T, std::enable_if_t<bond::has_schema<T>::value>> : DataTypeOf<bond::BondDataType::BT_STRUCT> {};
+
+        template <typename T, typename Allocator>
+        struct DataType<std::vector<T, Allocator>> : DataTypeOf<bond::BondDataType::BT_LIST> {};
+
+
+        template <typename T>
+        std::make_unsigned_t<T> EncodeZigZag(T value)
+        {
+            return static_cast<std::make_unsigned_t<T>>((value << 1) ^ (value >> (sizeof(T) * 8 - 1)));
+        }
+
+        template <typename T>
+        T DecodeZigZag(T value)
+        {
+            return (value >> 1) ^ (~(value & 1) + 1);
+        }
+
+
+        template <typename Buffer>
+        void WriteString(Buffer& output, const std::string& value)
+        {
+            const auto size = static_cast<std::uint32_t>(value.size());
+
+            output.WriteVariableUnsigned(size);
+
+            if (size != 0)
+            {
+                output.Write(value.data(), size);
+            }
+        }
+
+        template <typename Buffer>
+        void ReadString(Buffer& input, std::string& value)
+        {
+            std::uint32_t size;
+            input.ReadVariableUnsigned(size);
+
+            value.resize(size);
+
+            if (size != 0)
+            {
+                input.Read(&value[0], size);
+            }
+        }
+
+
+        struct CompactBinary
+        {
+            static constexpr bond::ProtocolType Protocol = bond::ProtocolType::COMPACT_PROTOCOL;
+            static constexpr std::uint16_t Version = 1;
+
+            template <typename Buffer>
+            static void WriteFieldBegin(Buffer& output, bond::BondDataType type, std::uint16_t id)
+            {
+                if (id <= 5)
+                {
+                    output.Write(static_cast<std::uint8_t>(type | (id << 5)));
+                }
+                else if (id <= 0xff)
+                {
+                    output.Write(static_cast<std::uint8_t>(type | (6 << 5)));
+                    output.Write(static_cast<std::uint8_t>(id));
+                }
+                else
+                {
+                    output.Write(static_cast<std::uint8_t>(type | (7 << 5)));
+                    output.Write(id);
+                }
+            }
+
+            template <typename Buffer>
+            static void WriteContainerBegin(Buffer& output, bond::BondDataType type, std::uint32_t size)
+            {
+                output.Write(static_cast<std::uint8_t>(type));
+                output.WriteVariableUnsigned(size);
+            }
+
+            template <typename Buffer>
+            static void ReadFieldBegin(Buffer& input, bond::BondDataType& type, std::uint16_t& id)
+            {
+                std::uint8_t raw;
+                input.Read(raw);
+
+                type = static_cast<bond::BondDataType>(raw & 0x1f);
+                id = raw >> 5;
+
+                if (id == 6)
+                {
+                    std::uint8_t value;
+                    input.Read(value);
+                    id = value;
+                }
+                else if (id == 7)
+                {
+                    input.Read(id);
+                }
+            }
+
+            template <typename Buffer, typename T, std::enable_if_t<std::is_enum<T>::value>* = nullptr>
+            static void Write(Buffer& output, T value)
+            {
+                Write(output, static_cast<std::int32_t>(value));
+            }
+
+            template <typename Buffer, typename T, std::enable_if_t<std::is_integral<T>::value && (sizeof(T) > 1)>* = nullptr>
+            static void Write(Buffer& output, T value)
+            {
+                output.WriteVariableUnsigned(Encode(value, std::is_signed<T>{}));
+            }
+
+            template <typename Buffer, typename T, std::enable_if_t<std::is_floating_point<T>::value || (std::is_integral<T>::value && sizeof(T) == 1)>* = nullptr>
+            static void Write(Buffer& output, T value)
+            {
+                output.Write(value);
+            }
+
+            template <typename Buffer>
+            static void Write(Buffer& output, const std::string& value)
+            {
+                WriteString(output, value);
+            }
+
+            template <typename Buffer, typename T, std::enable_if_t<std::is_enum<T>::value>* = nullptr>
+            static void Read(Buffer& input, T& value)
+            {
+                std::int32_t raw;
+                Read(input, raw);
+                value = static_cast<T>(raw);
+            }
+
+            template <typename Buffer, typename T, std::enable_if_t<std::is_integral<T>::value && (sizeof(T) > 1)>* = nullptr>
+            static void Read(Buffer& input, T& value)
+            {
+                std::make_unsigned_t<T> raw;
+                input.ReadVariableUnsigned(raw);
+                value = static_cast<T>(std::is_signed<T>::value ? DecodeZigZag(raw) : raw);
+            }
+
+            template <typename Buffer, typename T, std::enable_if_t<std::is_floating_point<T>::value || (std::is_integral<T>::value && sizeof(T) == 1)>* = nullptr>
+            static void Read(Buffer& input, T& value)
+            {
+                input.Read(value);
+            }
+
+            template <typename Buffer>
+            static void Read(Buffer& input, std::string& value)
+            {
+                ReadString(input, value);
+            }
+
+        private:
+            template <typename T>
+            static auto Encode(T value, std::true_type /*isSigned*/)
+            {
+                return EncodeZigZag(value);
+            }
+
+            template <typename T>
+            static auto Encode(T value, std::false_type /*isSigned*/)
+            {
+                return value;
+            }
+        };
+
+
+        struct FastBinary
+        {
+            static constexpr bond::ProtocolType Protocol = bond::ProtocolType::FAST_PROTOCOL;
+            static constexpr std::uint16_t Version = 1;
+
+            template <typename Buffer>
+            static void WriteFieldBegin(Buffer& output, bond::BondDataType type, std::uint16_t id)
+            {
+                output.Write(static_cast<std::uint8_t>(type));
+                output.Write(id);
+            }
+
+            template <typename Buffer>
+            static void WriteContainerBegin(Buffer& output, bond::BondDataType type, std::uint32_t size)
+            {
+                output.Write(static_cast<std::uint8_t>(type));
+                output.WriteVariableUnsigned(size);
+            }
+
+            template <typename Buffer>
+            static void ReadFieldBegin(Buffer& input, bond::BondDataType& type, std::uint16_t& id)
+            {
+                std::uint8_t raw;
+                input.Read(raw);
+
+                type = static_cast<bond::BondDataType>(raw);
+                id = 0;
+
+                if (type != bond::BondDataType::BT_STOP && type != bond::BondDataType::BT_STOP_BASE)
+                {
+                    input.Read(id);
+                }
+            }
+
+            template <typename Buffer, typename T, std::enable_if_t<std::is_enum<T>::value>* = nullptr>
+            static void Write(Buffer& output, T value)
+            {
+                output.Write(static_cast<std::int32_t>(value));
+            }
+
+            template <typename Buffer, typename T, std::enable_if_t<std::is_arithmetic<T>::value>* = nullptr>
+            static void Write(Buffer& output, T value)
+            {
+                output.Write(value);
+            }
+
+            template <typename Buffer>
+            static void Write(Buffer& output, const std::string& value)
+            {
+                WriteString(output, value);
+            }
+
+            template <typename Buffer, typename T, std::enable_if_t<std::is_enum<T>::value>* = nullptr>
+            static void Read(Buffer& input, T& value)
+            {
+                std::int32_t raw;
+                input.Read(raw);
+                value = static_cast<T>(raw);
+            }
+
+            template <typename Buffer, typename T, std::enable_if_t<std::is_arithmetic<T>::value>* = nullptr>
+            static void Read(Buffer& input, T& value)
+            {
+                input.Read(value);
+            }
+
+            template <typename Buffer>
+            static void Read(Buffer& input, std::string& value)
+            {
+                ReadString(input, value);
+            }
+        };
+
+
+        template <typename Field>
+        using IsOptional = std::is_same<typename Field::field_modifier, bond::reflection::optional_field_modifier>;
+
+        template <typename Field>
+        using IsRequired = std::is_same<typename Field::field_modifier, bond::reflection::required_field_modifier>;
+
+        template <typename Encoding, typename Buffer, typename T>
+        void Encode(Buffer& output, const T& value);
+
+        template <typename Encoding, typename Buffer, typename T>
+        void WriteValue(Buffer& output, const T& value);
+
+        template <typename Encoding, typename Buffer, typename T, typename Allocator>
+        void WriteValue(Buffer& output, const std::vector<T, Allocator>& value);
+
+        template <typename Encoding, typename Buffer, typename T>
+        void WriteValue(Buffer& output, const T& value, std::false_type /*hasSchema*/)
+        {
+            Encoding::Write(output, value);
+        }
+
+        template <typename Encoding, typename Buffer, typename T>
+        void WriteValue(Buffer& output, const T& value, std::true_type /*hasSchema*/)
+        {
+            Encode<Encoding>(output, value);
+        }
+
+        template <typename Encoding, typename Buffer, typename T>
+        void WriteValue(Buffer& output, const T& value)
+        {
+            WriteValue<Encoding>(output, value, bond::has_schema<T>{});
+        }
+
+        template <typename Encoding, typename Buffer, typename T, typename Allocator>
+        void WriteValue(Buffer& output, const std::vector<T, Allocator>& value)
+        {
+            Encoding::WriteContainerBegin(output, DataType<T>::value, static_cast<std::uint32_t>(value.size()));
+
+            for (const auto& element : value)
+            {
+                WriteValue<Encoding>(output, element);
+            }
+        }
+
+        // Writer is invoked as writer(const FieldType&) to emit each field value after its header.
+        template <typename Encoding, typename Buffer, typename T, typename Writer>
+        void Encode(Buffer& output, const T& value, Writer&& writer)
+        {
+            static_assert(std::is_same<typename Schema<T>::base, bond::no_base>::value, "Static codec does not support inheritance.");
+
+            Fields<T>::ForEach(
+                [&](auto field)
+                {
+                    using Field = decltype(field);
+                    using FieldType = typename Field::field_type;
+
+                    const auto& fieldValue = Field::GetVariable(value);
+
+                    // Mirror bond::Serializer which omits optional fields holding default values.
+                    if (!IsOptional<Field>::value || !(fieldValue == Field::GetVariable(GetDefault<T>())))
+                    {
+                        Encoding::WriteFieldBegin(output, DataType<FieldType>::value, Field::id);
+                        writer(fieldValue);
+                    }
+                });
+
+            output.Write(static_cast<std::uint8_t>(bond::BondDataType::BT_STOP));
+        }
+
+        template <typename Encoding, typename Buffer, typename T>
+        void Encode(Buffer& output, const T& value)
+        {
+            Encode<Encoding>(output, value, [&](const auto& fieldValue) { WriteValue<Encoding>(output, fieldValue); });
+        }
+
+        // Returns false when the payload does not follow the schema field order (unknown, reordered or
+        // retyped fields) or lacks a required field, so the caller must fall back to bond.
+        template <typename Encoding, typename Buffer, typename T>
+        bool Decode(Buffer& input, T& value)
+        {
+            static_assert(std::is_same<typename Schema<T>::base, bond::no_base>::value, "Static codec does not support inheritance.");
+
+            bond::BondDataType type;
+            std::uint16_t id;
+            Encoding::ReadFieldBegin(input, type, id);
+
+            bool isComplete = true;
+
+            Fields<T>::ForEach(
+                [&](auto field)
+                {
+                    using Field = decltype(field);
+                    using FieldType = typename Field::field_type;
+
+                    auto& fieldValue = Field::GetVariable(value);
+
+                    if (type == DataType<FieldType>::value && id == Field::id)
+                    {
+                        Encoding::Read(input, fieldValue);
+                        Encoding::ReadFieldBegin(input, type, id);
+                    }
+                    else
+                    {
+                        // Let bond report a missing required field.
+                        isComplete = isComplete && !IsRequired<Field>::value;
+                        fieldValue = Field::GetVariable(GetDefault<T>());
+                    }
+                });
+
+            return isComplete && type == bond::BondDataType::BT_STOP;
+        }
+
+    } // StaticCodec
+    } // detail
+
+
+    template <typename Encoding, typename BufferPool, typename T>
+    typename BufferPool::ConstBuffer StaticSerialize(std::shared_ptr<BufferPool> pool, const T& value, bool marshal, std::size_t minBlobSize = 0, std::size_t alignedBlobSize = 0)
+    {
+        OutputBuffer<BufferPool> output{ std::move(pool), minBlobSize, alignedBlobSize };
+
+        if (marshal)
+        {
+            output.Write(static_cast<std::uint16_t>(Encoding::Protocol));
+            output.Write(static_cast<std::uint16_t>(Encoding::Version));
+        }
+
+        detail::StaticCodec::Encode<Encoding>(output, value);
+
+        return std::move(output).GetBuffer();
+    }
+
+    template <typename Encoding, typename ConstBuffer, typename T>
+    bool StaticDeserialize(ConstBuffer buffer, T& value, bool marshal, std::shared_ptr<SharedMemory> memory, std::shared_ptr<SharedMemory> otherMemory = {})
+    {
+        InputBuffer<ConstBuffer> input{ std::move(buffer), std::move(memory), std::move(otherMemory) };
+
+        if (marshal)
+        {
+            std::uint16_t protocol, version;
+            input.Read(protocol);
+            input.Read(version);
+
+            if (protocol != static_cast<std::uint16_t>(Encoding::Protocol) || version != Encoding::Version)
+            {
+                return false;
+            }
+        }
+
+        return detail::StaticCodec::Decode<Encoding>(input, value);
+    }
+
+
+    using StaticCompactBinary = detail::StaticCodec::CompactBinary;
+    using StaticFastBinary = detail::StaticCodec::FastBinary;
+
+} // Bond
+} // IPC
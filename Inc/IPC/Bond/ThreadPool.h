@@ -0,0 +1,124 @@
+#pragma once
+
+#include <IPC/DefaultTraits.h>
+#include "InplaceFunction.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace IPC
+{
+namespace Bond
+{
+    class ThreadPool
+    {
+    public:
+        using ErrorHandler = std::function<void(std::exception_ptr)>;
+
+        // The error handler is invoked on a pool thread with every exception escaping a task. Defaults to
+        // the one of IPC::DefaultTraits, as for Accept and Proxy.
+        explicit ThreadPool(
+            std::size_t threadCount = std::thread::hardware_concurrency(),
+            ErrorHandler errorHandler = IPC::DefaultTraits::ErrorHandler{})
+            : m_errorHandler{ errorHandler ? std::move(errorHandler) : ErrorHandler{ IPC::DefaultTraits::ErrorHandler{} } }
+        {
+            threadCount = (std::max)(threadCount, std::size_t{ 1 });
+            m_threads.reserve(threadCount);
+
+            for (std::size_t i = 0; i < threadCount; ++i)
+            {
+                m_threads.emplace_back([this] { Run(); });
+            }
+        }
+
+        ThreadPool(const ThreadPool& other) = delete;
+        ThreadPool& operator=(const ThreadPool& other) = delete;
+
+        ~ThreadPool()
+        {
+            {
+                std::lock_guard<std::mutex> guard{ m_lock };
+                m_stopped = true;
+            }
+
+            m_condition.notify_all();
+
+            for (auto& thread : m_threads)
+            {
+                thread.join();
+            }
+        }
+
+        template <typename Function>
+        void Submit(Function&& func)
+        {
+            {
+                std::lock_guard<std::mutex> guard{ m_lock };
+
+                // Tasks may be move-only (e.g. hold a std::packaged_task).
+                m_tasks.emplace_back(std::forward<Function>(func));
+            }
+
+            m_condition.notify_one();
+        }
+
+        std::size_t GetThreadCount() const
+        {
+            return m_threads.size();
+        }
+
+        // Used by tasks which must keep running after a failure (e.g. strands draining a queue).
+        void ReportError(std::exception_ptr error) const
+        {
+            m_errorHandler(std::move(error));
+        }
+
+    private:
+        void Run()
+        {
+            std::unique_lock<std::mutex> guard{ m_lock };
+
+            while (true)
+            {
+                m_condition.wait(guard, [this] { return m_stopped || !m_tasks.empty(); });
+
+                if (m_tasks.empty())
+                {
+                    return;
+                }
+
+                auto task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+
+                guard.unlock();
+
+                try
+                {
+                    task();
+                }
+                catch (...)
+                {
+                    ReportError(std::current_exception());
+                }
+
+                guard.lock();
+            }
+        }
+
+        const ErrorHandler m_errorHandler;
+        std::mutex m_lock;
+        std::condition_variable m_condition;
+        std::deque<InplaceFunction<void()>> m_tasks;
+        bool m_stopped{ false };
+        std::vector<std::thread> m_threads;     // Must be declared last.
+    };
+
+} // Bond
+} // IPC
@@ -38,7 +38,9 @@ namespace Bond
             std::size_t hostInfoMemorySize = 0,
             typename Traits::TimeoutFactory timeoutFactory = {},
             typename Traits::ErrorHandler errorHandler = {},
-            typename Traits::TransactionManagerFactory transactionManagerFactory = {})
+            typename Traits::TransactionManagerFactory transactionManagerFactory = {},
+            typename Traits::DeserializationScheduler scheduler = {},
+            typename Traits::ResponseCache cache = {})
             : m_protocol{ protocol },
               m_marshal{ marshal },
               m_channelSettings{ std::move(channelSettings) },
@@ -46,7 +48,9 @@ namespace Bond
               m_hostInfoMemorySize{ hostInfoMemorySize },
               m_timeoutFactory{ std::move(timeoutFactory) },
               m_errorHandler{ std::move(errorHandler) },
-              m_transactionManagerFactory{ std::move(transactionManagerFactory) }
+              m_transactionManagerFactory{ std::move(transactionManagerFactory) },
+              m_scheduler{ std::move(scheduler) },
+              m_cache{ std::move(cache) }
         {}
 
         template <typename CloseHandler>
@@ -58,7 +62,8 @@ namespace Bond
                 m_protocol,
                 m_marshal,
                 m_minBlobSize,
-                m_transactionManagerFactory(IPC::detail::Identity<typename Client::TransactionManager>{}));
+                m_transactionManagerFactory(IPC::detail::Identity<typename Client::TransactionManager>{}),
+                m_scheduler);
         }
 
         template <typename HandlerFactory, typename CloseHandler>
@@ -70,7 +75,9 @@ namespace Bond
                 std::forward<CloseHandler>(closeHandler),
                 m_protocol,
                 m_marshal,
-                m_minBlobSize);
+                m_minBlobSize,
+                m_scheduler,
+                m_cache);
         }
 
         auto MakeClientConnector()
@@ -111,7 +118,7 @@ namespace Bond
                 connector = m_clientConnector;
             }
 
-            return IPC::Bond::ConnectClient(
+            return IPC::Bond::detail::ConnectClient(
                 name,
                 connector,
                 async,
@@ -121,6 +128,7 @@ namespace Bond
                 m_timeoutFactory,
                 m_errorHandler,
                 m_transactionManagerFactory,
+                m_scheduler,
                 std::forward<TransactionArgs>(transactionArgs)...);
         }
 
@@ -141,7 +149,7 @@ namespace Bond
                 connector = m_serverConnector;
             }
 
-            return IPC::Bond::ConnectServer(
+            return IPC::Bond::detail::ConnectServer(
                 name,
                 connector,
                 std::forward<HandlerFactory>(handlerFactory),
@@ -151,6 +159,8 @@ namespace Bond
                 m_minBlobSize,
                 m_timeoutFactory,
                 m_errorHandler,
+                m_scheduler,
+                m_cache,
                 std::forward<TransactionArgs>(transactionArgs)...);
         }
 
@@ -165,7 +175,9 @@ namespace Bond
                 m_channelSettings,
                 m_minBlobSize,
                 m_hostInfoMemorySize,
-                m_errorHandler);
+                m_errorHandler,
+                m_scheduler,
+                m_cache);
         }
 
         auto AcceptClients(const char* name)
@@ -178,7 +190,8 @@ namespace Bond
                 m_minBlobSize,
                 m_hostInfoMemorySize,
                 m_errorHandler,
-                m_transactionManagerFactory);
+                m_transactionManagerFactory,
+                m_scheduler);
         }
 
     private:
@@ -190,6 +203,8 @@ namespace Bond
         typename Traits::TimeoutFactory m_timeoutFactory;
         typename Traits::ErrorHandler m_errorHandler;
         typename Traits::TransactionManagerFactory m_transactionManagerFactory;
+        typename Traits::DeserializationScheduler m_scheduler;
+        typename Traits::ResponseCache m_cache;
         std::shared_ptr<ClientConnector> m_clientConnector;
         std::shared_ptr<ServerConnector> m_serverConnector;
         std::once_flag m_clientConnectorOnceFlag;
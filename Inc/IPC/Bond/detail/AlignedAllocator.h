@@ -0,0 +1,156 @@
+#pragma once
+
+#include <boost/interprocess/containers/allocation_type.hpp>
+#include <boost/interprocess/containers/version_type.hpp>
+#include <boost/interprocess/offset_ptr.hpp>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+
+namespace IPC
+{
+namespace Bond
+{
+    namespace detail
+    {
+        constexpr std::size_t CacheLineSize = 64;
+
+        // Keeps the neighbouring members of a shared memory object off each other's cache lines when
+        // the segment manager gives no alignment guarantee for the object itself.
+        struct CacheLinePadding
+        {
+            char m_padding[CacheLineSize];
+        };
+
+
+        // Allocator placing every allocation in the segment of SegmentManager at an Alignment boundary.
+        // It is a version 2 allocator, so containers still grow and shrink in place. Only commands which
+        // keep the start of a block are forwarded to the segment manager, new blocks are always aligned.
+        template <typename T, typename SegmentManager, std::size_t Alignment = CacheLineSize>
+        class AlignedAllocator
+        {
+        public:
+            using value_type = T;
+            using pointer = boost::interprocess::offset_ptr<T>;
+            using const_pointer = boost::interprocess::offset_ptr<const T>;
+            using void_pointer = boost::interprocess::offset_ptr<void>;
+            using const_void_pointer = boost::interprocess::offset_ptr<const void>;
+            using difference_type = std::ptrdiff_t;
+            using size_type = std::size_t;
+            using version = boost::interprocess::version_type<AlignedAllocator, 2>;
+
+            template <typename U>
+            struct rebind
+            {
+                using other = AlignedAllocator<U, SegmentManager, Alignment>;
+            };
+
+            AlignedAllocator(SegmentManager* segmentManager) noexcept
+                : m_segmentManager{ segmentManager }
+            {}
+
+            template <typename Allocator, typename = decltype(std::declval<const Allocator&>().get_segment_manager())>
+            AlignedAllocator(const Allocator& allocator) noexcept
+                : m_segmentManager{ allocator.get_segment_manager() }
+            {}
+
+            template <typename U>
+            AlignedAllocator(const AlignedAllocator<U, SegmentManager, Alignment>& other) noexcept
+                : m_segmentManager{ other.GetSegmentManager() }
+            {}
+
+            pointer allocate(std::size_t count)
+            {
+                if (count > static_cast<std::size_t>(-1) / sizeof(T))
+                {
+                    throw std::bad_alloc{};
+                }
+
+                // Throws bad_alloc when the segment is exhausted.
+                return pointer{ static_cast<T*>(m_segmentManager->allocate_aligned(count * sizeof(T), Alignment)) };
+            }
+
+            pointer allocation_command(
+                boost::interprocess::allocation_type command,
+                size_type limitSize,
+                size_type& preferInRecvdOutSize,
+                pointer& reuse)
+            {
+                namespace bi = boost::interprocess;
+
+                // Backward expansion would move the start of the block off the alignment boundary.
+                const auto inPlace = command & (bi::expand_fwd | bi::shrink_in_place | bi::try_shrink_in_place);
+
+                if (reuse && inPlace)
+                {
+                    auto size = preferInRecvdOutSize;
+                    auto ptr = reuse.get();
+
+                    if (m_segmentManager->allocation_command(
+                            inPlace | (command & bi::zero_memory) | bi::nothrow_allocation, limitSize, size, ptr))
+                    {
+                        preferInRecvdOutSize = size;
+                        return reuse;
+                    }
+                }
+
+                if (command & bi::allocate_new)
+                {
+                    for (auto size : { preferInRecvdOutSize, limitSize })
+                    {
+                        if (size <= static_cast<std::size_t>(-1) / sizeof(T))
+                        {
+                            if (auto ptr = m_segmentManager->allocate_aligned(size * sizeof(T), Alignment, std::nothrow))
+                            {
+                                preferInRecvdOutSize = size;
+                                reuse = nullptr;
+                                return pointer{ static_cast<T*>(ptr) };
+                            }
+                        }
+                    }
+                }
+
+                if (!(command & bi::nothrow_allocation))
+                {
+                    throw std::bad_alloc{};
+                }
+
+                return nullptr;
+            }
+
+            size_type size(const pointer& ptr) const noexcept
+            {
+                return m_segmentManager->size(ptr.get()) / sizeof(T);
+            }
+
+            void deallocate(const pointer& ptr, std::size_t /*count*/) noexcept
+            {
+                m_segmentManager->deallocate(ptr.get());
+            }
+
+            SegmentManager* GetSegmentManager() const noexcept
+            {
+                return m_segmentManager.get();
+            }
+
+            template <typename U>
+            bool operator==(const AlignedAllocator<U, SegmentManager, Alignment>& other) const noexcept
+            {
+                return GetSegmentManager() == other.GetSegmentManager();
+            }
+
+            template <typename U>
+            bool operator!=(const AlignedAllocator<U, SegmentManager, Alignment>& other) const noexcept
+            {
+                return !(*this == other);
+            }
+
+        private:
+            boost::interprocess::offset_ptr<SegmentManager> m_segmentManager;
+        };
+
+    } // detail
+
+} // Bond
+} // IPC
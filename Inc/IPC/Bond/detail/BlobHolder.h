@@ -1,7 +1,11 @@
 #pragma once
 
 #include <bond/core/blob.h>
+#include <atomic>
 #include <cassert>
+#include <cstddef>
+#include <new>
+#include <utility>
 
 
 namespace IPC
@@ -36,6 +40,265 @@ namespace Bond
             Blob m_blob;
         };
 
+        // Recycles fixed size blocks through a per-thread free list. Every block remembers the thread which
+        // created it, blocks released on another thread are pushed to a lock-free return list of that thread
+        // and reclaimed once its own free list runs empty. The lists are bounded and emptied on thread exit.
+        template <std::size_t Size, std::size_t Alignment, std::size_t Capacity = 256>
+        class FixedSizePool
+        {
+            static_assert(Alignment <= alignof(std::max_align_t), "Over-aligned blocks are not supported.");
+
+        public:
+            static void* Allocate()
+            {
+                auto& cache = GetCache();
+
+                if (cache.m_count == 0 && cache.m_owner)
+                {
+                    cache.Reclaim();
+                }
+
+                return cache.m_count != 0 ? cache.m_blocks[--cache.m_count] : Create(cache.GetOwner());
+            }
+
+            static void Deallocate(void* block) noexcept
+            {
+                auto owner = GetOwner(block);
+                auto& cache = GetCache();
+
+                if (owner == nullptr || (owner == cache.m_owner && cache.m_count == Capacity))
+                {
+                    Destroy(block);
+                }
+                else if (owner == cache.m_owner)
+                {
+                    cache.m_blocks[cache.m_count++] = block;
+                }
+                else
+                {
+                    owner->Return(block);
+                }
+            }
+
+        private:
+            // Shared by the owning thread and all blocks it created, the last one deletes it.
+            class Owner
+            {
+            public:
+                void Return(void* block) noexcept
+                {
+                    auto head = m_returned.load(std::memory_order_relaxed);
+
+                    do
+                    {
+                        if (head == this)
+                        {
+                            Destroy(block);     // The owning thread has exited.
+                            return;
+                        }
+
+                        Next(block) = head;
+
+                    } while (!m_returned.compare_exchange_weak(head, block, std::memory_order_release, std::memory_order_relaxed));
+                }
+
+                // Takes the whole list at once, so popping never races with pushing.
+                void* TakeReturned() noexcept
+                {
+                    return m_returned.exchange(nullptr, std::memory_order_acquire);
+                }
+
+                // Makes further returns destroy the blocks, the list then holds its own address.
+                void* Close() noexcept
+                {
+                    return m_returned.exchange(this, std::memory_order_acquire);
+                }
+
+                void AddRef() noexcept
+                {
+                    m_references.fetch_add(1, std::memory_order_relaxed);
+                }
+
+                void Release() noexcept
+                {
+                    if (m_references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    {
+                        delete this;
+                    }
+                }
+
+            private:
+                std::atomic<void*> m_returned{ nullptr };
+                std::atomic<std::size_t> m_references{ 1 };
+            };
+
+            // Trivially destructible, so it stays accessible while other thread locals are destroyed.
+            struct Cache
+            {
+                Owner* GetOwner()
+                {
+                    if (m_owner == nullptr && !m_isClosed)
+                    {
+                        m_owner = new Owner;
+                    }
+
+                    return m_owner;
+                }
+
+                void Reclaim() noexcept
+                {
+                    for (auto block = m_owner->TakeReturned(); block != nullptr; )
+                    {
+                        auto next = Next(block);
+
+                        if (m_count != Capacity)
+                        {
+                            m_blocks[m_count++] = block;
+                        }
+                        else
+                        {
+                            Destroy(block);
+                        }
+
+                        block = next;
+                    }
+                }
+
+                void* m_blocks[Capacity];
+                std::size_t m_count;
+                Owner* m_owner;
+                bool m_isClosed;
+            };
+
+            struct Cleanup
+            {
+                ~Cleanup()
+                {
+                    auto& cache = s_cache;
+                    cache.m_isClosed = true;
+
+                    while (cache.m_count != 0)
+                    {
+                        Destroy(cache.m_blocks[--cache.m_count]);
+                    }
+
+                    if (auto owner = std::exchange(cache.m_owner, nullptr))
+                    {
+                        for (auto block = owner->Close(); block != nullptr; )
+                        {
+                            auto next = Next(block);
+                            Destroy(block);
+                            block = next;
+                        }
+
+                        owner->Release();
+                    }
+                }
+            };
+
+            // The owner is stored in front of each block, padded to keep the block aligned.
+            static constexpr std::size_t HeaderSize = (sizeof(Owner*) + Alignment - 1) / Alignment * Alignment;
+
+            static constexpr std::size_t BlockSize = Size < sizeof(void*) ? sizeof(void*) : Size;
+
+            static void* Create(Owner* owner)
+            {
+                auto header = static_cast<char*>(::operator new(HeaderSize + BlockSize));
+                *reinterpret_cast<Owner**>(header) = owner;
+
+                if (owner)
+                {
+                    owner->AddRef();
+                }
+
+                return header + HeaderSize;
+            }
+
+            static void Destroy(void* block) noexcept
+            {
+                auto owner = GetOwner(block);
+
+                ::operator delete(static_cast<char*>(block) - HeaderSize);
+
+                if (owner)
+                {
+                    owner->Release();
+                }
+            }
+
+            static Owner* GetOwner(void* block) noexcept
+            {
+                return *reinterpret_cast<Owner**>(static_cast<char*>(block) - HeaderSize);
+            }
+
+            // Links free blocks of the return list through their first bytes.
+            static void*& Next(void* block) noexcept
+            {
+                return *static_cast<void**>(block);
+            }
+
+            static Cache& GetCache() noexcept
+            {
+                thread_local Cleanup cleanup;
+                (void)cleanup;
+
+                return s_cache;
+            }
+
+            static thread_local Cache s_cache;
+        };
+
+        template <std::size_t Size, std::size_t Alignment, std::size_t Capacity>
+        thread_local typename FixedSizePool<Size, Alignment, Capacity>::Cache FixedSizePool<Size, Alignment, Capacity>::s_cache{};
+
+
+        // Serves single objects from FixedSizePool, used for control blocks of the bond::blob holders and
+        // shared states of futures.
+        template <typename T>
+        class PooledAllocator
+        {
+        public:
+            using value_type = T;
+
+            template <typename U>
+            struct rebind
+            {
+                using other = PooledAllocator<U>;
+            };
+
+            PooledAllocator() = default;
+
+            template <typename U>
+            PooledAllocator(const PooledAllocator<U>& /*other*/) noexcept
+            {}
+
+            T* allocate(std::size_t count)
+            {
+                return static_cast<T*>(count == 1 ? Pool::Allocate() : ::operator new(count * sizeof(T)));
+            }
+
+            void deallocate(T* ptr, std::size_t count) noexcept
+            {
+                count == 1 ? Pool::Deallocate(ptr) : ::operator delete(ptr);
+            }
+
+            template <typename U>
+            bool operator==(const PooledAllocator<U>& /*other*/) const noexcept
+            {
+                return true;
+            }
+
+            template <typename U>
+            bool operator!=(const PooledAllocator<U>& /*other*/) const noexcept
+            {
+                return false;
+            }
+
+        private:
+            using Pool = FixedSizePool<sizeof(T), alignof(T)>;
+        };
+
+
         struct BlobHook : boost::shared_ptr<const char[]>
         {
             using shared_ptr::shared_ptr;
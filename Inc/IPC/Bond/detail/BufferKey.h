@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+
+
+namespace IPC
+{
+namespace Bond
+{
+    namespace detail
+    {
+        template <typename Buffer>
+        std::string MakeBufferKey(const Buffer& buffer)
+        {
+            std::string key;
+
+            if (buffer)
+            {
+                key.reserve(buffer.size());
+
+                for (const auto& blob : buffer)
+                {
+                    key.append(blob.data(), blob.size());
+                }
+            }
+
+            return key;
+        }
+
+    } // detail
+} // Bond
+} // IPC
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "ProtocolNegotiation.h"
 #include <memory>
 
 
@@ -35,7 +36,7 @@ namespace Bond
 
 
         template <typename BufferPool, typename Connection>
-        auto MakeBufferPoolHolder(const Connection& connection)
+        auto MakeBufferPoolHolder(const Connection& connection, bool enablePeerReferences = false)
         {
             auto pools = std::make_shared<std::pair<BufferPool, BufferPool>>(
                 std::piecewise_construct,
@@ -44,6 +45,13 @@ namespace Bond
 
             auto& pair = *pools;
 
+            if (enablePeerReferences)
+            {
+                // Blobs received from the peer can be sent back to it without copying, once it enabled references too.
+                pair.second.EnablePeerReferences(pair.first.GetMemory());
+                ProtocolNegotiation::AdvertisePeerReferences(*pair.second.GetMemory());
+            }
+
             std::shared_ptr<BufferPool> in{ pools, &pair.first };
             std::shared_ptr<BufferPool> out{ std::move(pools), &pair.second };
 
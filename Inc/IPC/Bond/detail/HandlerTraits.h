@@ -0,0 +1,133 @@
+#pragma once
+
+#include <exception>
+#include <future>
+#include <type_traits>
+#include <utility>
+
+
+namespace IPC
+{
+namespace Bond
+{
+    namespace detail
+    {
+        template <typename Function, typename T, typename = void>
+        struct AcceptsFuture : std::false_type
+        {};
+
+        template <typename Function, typename T>
+        struct AcceptsFuture<Function, T, decltype(std::declval<Function&>()(std::declval<std::future<T>>()), void())> : std::true_type
+        {};
+
+
+        template <typename Function, typename T, typename Callback, typename = void>
+        struct AcceptsFutureWithCallback : std::false_type
+        {};
+
+        template <typename Function, typename T, typename Callback>
+        struct AcceptsFutureWithCallback<
+            Function, T, Callback, decltype(std::declval<Function&>()(std::declval<std::future<T>>(), std::declval<Callback>()), void())>
+            : std::true_type
+        {};
+
+
+        template <typename Function, typename T, typename = void>
+        struct AcceptsValue : std::false_type
+        {};
+
+        template <typename Function, typename T>
+        struct AcceptsValue<Function, T, decltype(std::declval<Function&>()(std::declval<T>()), void())> : std::true_type
+        {};
+
+
+        // Future is probed first, so generic lambdas keep receiving std::future<T>.
+        template <typename Function, typename T>
+        struct IsValueCallback
+            : std::conditional_t<AcceptsFuture<Function, T>::value, std::false_type, AcceptsValue<Function, T>>
+        {};
+
+
+        // Converts handlers of other forms to ones Server can invoke, specialized for coroutines in Coroutine.h.
+        template <typename Handler, typename Request, typename Response, typename ErrorHandler, typename = void>
+        struct HandlerAdapter
+        {
+            template <typename H>
+            static H&& Adapt(H&& handler)
+            {
+                return std::forward<H>(handler);
+            }
+        };
+
+
+        // Keeps the object taken from the pool alive until the callback is released.
+        template <typename Holder, typename Callback>
+        class HoldingCallback
+        {
+        public:
+            HoldingCallback(Holder&& holder, Callback&& callback)
+                : m_holder{ std::move(holder) },
+                  m_callback{ std::move(callback) }
+            {}
+
+            template <typename... Args>
+            decltype(auto) operator()(Args&&... args)
+            {
+                return m_callback(std::forward<Args>(args)...);
+            }
+
+        private:
+            Holder m_holder;
+            Callback m_callback;
+        };
+
+
+        // Failures are passed as std::exception_ptr to the same function.
+        // The object is taken from the pool and passed as T&&, it goes back to the pool once the function returns.
+        // Moving out of it is allowed but gives up its capacity.
+        template <typename T, typename Serializer, typename ObjectPool, typename Buffer, typename Function>
+        void DeserializeAndInvoke(Serializer& serializer, const ObjectPool& objects, Buffer&& buffer, Function& func)
+        {
+            auto value = objects.Take();
+
+            try
+            {
+                serializer.Deserialize(std::forward<Buffer>(buffer), *value);
+            }
+            catch (...)
+            {
+                func(std::current_exception());
+                return;
+            }
+
+            func(std::move(*value));
+        }
+
+        // Same as above, except that the object goes back to the pool once the callback passed along with it is
+        // released, so it stays valid until an asynchronous handler replies.
+        template <typename T, typename Serializer, typename ObjectPool, typename Buffer, typename Function, typename Callback>
+        void DeserializeAndInvoke(Serializer& serializer, const ObjectPool& objects, Buffer&& buffer, Function& func, Callback&& callback)
+        {
+            auto value = objects.Take();
+
+            try
+            {
+                serializer.Deserialize(std::forward<Buffer>(buffer), *value);
+            }
+            catch (...)
+            {
+                func(std::current_exception(), std::forward<Callback>(callback));
+                return;
+            }
+
+            // Holders keep the object at a stable address, so the reference outlives the move below.
+            auto& object = *value;
+
+            func(
+                std::move(object),
+                HoldingCallback<decltype(value), std::decay_t<Callback>>{ std::move(value), std::forward<Callback>(callback) });
+        }
+
+    } // detail
+} // Bond
+} // IPC
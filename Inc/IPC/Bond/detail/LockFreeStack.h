@@ -0,0 +1,193 @@
+#pragma once
+
+#include <boost/optional.hpp>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+namespace IPC
+{
+namespace Bond
+{
+    namespace detail
+    {
+        // Lock-free LIFO stack which may reside in shared memory. Nodes are addressed by their offset
+        // from the stack, so the stack works at any mapping address, and list heads carry a tag which is
+        // bumped on every change to prevent ABA. Popped nodes are recycled through a free list rather than
+        // deallocated, so a racing Pop may read a stale node but never a released one. Nodes must be
+        // allocated within a few terabytes of the stack, i.e. from the same segment.
+        template <typename T, typename Allocator>
+        class LockFreeStack
+        {
+        public:
+            explicit LockFreeStack(const Allocator& allocator)
+                : m_allocator{ allocator }
+            {}
+
+            LockFreeStack(const LockFreeStack& other) = delete;
+            LockFreeStack& operator=(const LockFreeStack& other) = delete;
+
+            ~LockFreeStack()
+            {
+                while (auto node = Pop(m_items))
+                {
+                    node->GetValue().~T();
+                    Deallocate(node);
+                }
+
+                while (auto node = Pop(m_free))
+                {
+                    Deallocate(node);
+                }
+            }
+
+            template <typename U>
+            void Push(U&& value)
+            {
+                auto node = Pop(m_free);
+
+                if (!node)
+                {
+                    node = Allocate();
+                }
+
+                try
+                {
+                    new (&node->m_value) T(std::forward<U>(value));
+                }
+                catch (...)
+                {
+                    Push(m_free, node);
+                    throw;
+                }
+
+                Push(m_items, node);
+            }
+
+            boost::optional<T> Pop()
+            {
+                boost::optional<T> value;
+
+                if (auto node = Pop(m_items))
+                {
+                    value.emplace(std::move(node->GetValue()));
+                    node->GetValue().~T();
+
+                    Push(m_free, node);
+                }
+
+                return value;
+            }
+
+            bool IsEmpty() const
+            {
+                return (m_items.load(std::memory_order_relaxed) & OffsetMask) == 0;
+            }
+
+        private:
+            static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "Shared memory requires address-free 64-bit atomics.");
+
+            struct Node
+            {
+                T& GetValue()
+                {
+                    return *reinterpret_cast<T*>(&m_value);
+                }
+
+                std::atomic<std::uint64_t> m_next{ 0 };
+                std::aligned_storage_t<sizeof(T), alignof(T)> m_value;
+            };
+
+            using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+            using NodePointer = typename std::allocator_traits<NodeAllocator>::pointer;
+
+            // Low bits hold the node offset in units of its alignment, high bits hold the tag.
+            static constexpr unsigned OffsetBits = 40;
+            static constexpr std::uint64_t OffsetMask = (std::uint64_t{ 1 } << OffsetBits) - 1;
+            static constexpr std::intptr_t OffsetUnit = alignof(Node);
+
+            std::uint64_t Encode(const Node* node) const
+            {
+                auto offset = (reinterpret_cast<std::intptr_t>(node) - reinterpret_cast<std::intptr_t>(this)) / OffsetUnit;
+                assert(offset != 0 && offset >= -(std::intptr_t{ 1 } << (OffsetBits - 1)) && offset < (std::intptr_t{ 1 } << (OffsetBits - 1)));
+
+                return static_cast<std::uint64_t>(offset) & OffsetMask;
+            }
+
+            Node* Decode(std::uint64_t head) const
+            {
+                if ((head & OffsetMask) == 0)
+                {
+                    return nullptr;
+                }
+
+                // Sign extends the offset.
+                auto offset = static_cast<std::int64_t>(head << (64 - OffsetBits)) >> (64 - OffsetBits);
+
+                return reinterpret_cast<Node*>(reinterpret_cast<std::intptr_t>(this) + static_cast<std::intptr_t>(offset) * OffsetUnit);
+            }
+
+            static std::uint64_t NextHead(std::uint64_t head, std::uint64_t offset)
+            {
+                return (((head >> OffsetBits) + 1) << OffsetBits) | offset;
+            }
+
+            void Push(std::atomic<std::uint64_t>& list, Node* node)
+            {
+                auto offset = Encode(node);
+                auto head = list.load(std::memory_order_relaxed);
+
+                do
+                {
+                    node->m_next.store(head & OffsetMask, std::memory_order_relaxed);
+                }
+                while (!list.compare_exchange_weak(head, NextHead(head, offset), std::memory_order_release, std::memory_order_relaxed));
+            }
+
+            Node* Pop(std::atomic<std::uint64_t>& list)
+            {
+                auto head = list.load(std::memory_order_acquire);
+
+                while (auto node = Decode(head))
+                {
+                    // May be stale when the node was popped meanwhile, the tag then fails the exchange.
+                    auto next = node->m_next.load(std::memory_order_relaxed);
+
+                    if (list.compare_exchange_weak(head, NextHead(head, next), std::memory_order_acquire, std::memory_order_acquire))
+                    {
+                        return node;
+                    }
+                }
+
+                return nullptr;
+            }
+
+            Node* Allocate()
+            {
+                NodeAllocator allocator{ m_allocator };
+                auto node = std::allocator_traits<NodeAllocator>::allocate(allocator, 1);
+
+                return new (&*node) Node{};
+            }
+
+            void Deallocate(Node* node)
+            {
+                NodeAllocator allocator{ m_allocator };
+                node->~Node();
+                std::allocator_traits<NodeAllocator>::deallocate(allocator, NodePointer{ node }, 1);
+            }
+
+            Allocator m_allocator;
+            std::atomic<std::uint64_t> m_items{ 0 };
+            std::atomic<std::uint64_t> m_free{ 0 };
+        };
+
+    } // detail
+
+} // Bond
+} // IPC
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <IPC/SharedMemory.h>
+#include <bond/core/bond_const_enum.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+
+namespace IPC
+{
+namespace Bond
+{
+    namespace detail
+    {
+        // Per-connection agreement on omitting the marshaling header. Each side publishes its descriptor in its
+        // output memory when created and fixes the encoding of its outgoing messages right before the first one
+        // is sent, so the receiver can always tell how the messages it gets were encoded. Peers which differ in
+        // protocol or format version, or do not negotiate at all, keep exchanging fully marshaled messages.
+        class ProtocolNegotiation
+        {
+        public:
+            ProtocolNegotiation(bond::ProtocolType protocol, std::shared_ptr<SharedMemory> inputMemory, std::shared_ptr<SharedMemory> outputMemory)
+                : m_descriptor{ MakeDescriptor(protocol) },
+                  m_inputMemory{ std::move(inputMemory) },
+                  m_outputMemory{ std::move(outputMemory) },
+                  m_local{ m_outputMemory->FindOrConstruct<State>(Name) }
+            {
+                m_local.m_descriptor.store(m_descriptor, std::memory_order_release);
+            }
+
+            ProtocolNegotiation(const ProtocolNegotiation& other) = delete;
+            ProtocolNegotiation& operator=(const ProtocolNegotiation& other) = delete;
+
+            bool IsOutputMarshaled()
+            {
+                auto mode = m_local.m_mode.load(std::memory_order_acquire);
+
+                if (mode == Undecided)
+                {
+                    auto remote = m_inputMemory->Find<State>(Name);
+
+                    auto desired = remote && remote->m_descriptor.load(std::memory_order_acquire) == m_descriptor ? Headerless : Marshaled;
+
+                    mode = Undecided;
+                    if (m_local.m_mode.compare_exchange_strong(mode, desired, std::memory_order_acq_rel))
+                    {
+                        mode = desired;
+                    }
+                }
+
+                return mode != Headerless;
+            }
+
+            bool IsInputMarshaled()
+            {
+                auto mode = m_remoteMode.load(std::memory_order_acquire);
+
+                if (mode == Undecided)
+                {
+                    // Peers publish their state when created, so a missing one means the peer does not negotiate.
+                    auto remote = m_inputMemory->Find<State>(Name);
+
+                    mode = remote ? remote->m_mode.load(std::memory_order_acquire) : Marshaled;
+
+                    if (mode == Undecided)
+                    {
+                        return true;    // Not cached, the peer has not sent anything headerless yet.
+                    }
+
+                    m_remoteMode.store(mode, std::memory_order_release);
+                }
+
+                return mode != Headerless;
+            }
+
+            // Withdraws the descriptor and fixes outgoing messages as marshaled, so the peer keeps sending marshaled
+            // ones too, e.g. for relaying buffers encoded by others. Returns false when headerless messages may
+            // already be exchanged in either direction, i.e. it must be called before anything is sent.
+            bool DisableHeaderless()
+            {
+                if (m_isHeaderlessDisabled.load(std::memory_order_acquire))
+                {
+                    return true;
+                }
+
+                m_local.m_descriptor.store(0, std::memory_order_release);
+
+                auto mode = Undecided;
+                m_local.m_mode.compare_exchange_strong(mode, Marshaled, std::memory_order_acq_rel);
+
+                if (mode == Headerless)
+                {
+                    return false;
+                }
+
+                auto remote = m_inputMemory->Find<State>(Name);
+
+                if (remote && remote->m_mode.load(std::memory_order_acquire) == Headerless)
+                {
+                    return false;
+                }
+
+                m_isHeaderlessDisabled.store(true, std::memory_order_release);
+                return true;
+            }
+
+            // Peer references (see BufferPool::EnablePeerReferences) are only sent to peers which advertised
+            // resolving them in their output memory. Must be called before anything is sent to the peer.
+            static void AdvertisePeerReferences(SharedMemory& outputMemory)
+            {
+                outputMemory.FindOrConstruct<State>(Name).m_features.fetch_or(PeerReferencesFeature, std::memory_order_release);
+            }
+
+            static bool IsPeerReferencesAdvertised(SharedMemory& inputMemory)
+            {
+                auto remote = inputMemory.Find<State>(Name);
+
+                return remote && (remote->m_features.load(std::memory_order_acquire) & PeerReferencesFeature) != 0;
+            }
+
+        private:
+            static constexpr const char* Name = "IPC.Bond.ProtocolNegotiation";
+
+            // Must be bumped whenever the headerless encoding changes.
+            static constexpr std::uint32_t Version = 1;
+
+            static constexpr std::uint32_t Undecided = 0;
+            static constexpr std::uint32_t Marshaled = 1;
+            static constexpr std::uint32_t Headerless = 2;
+
+            static constexpr std::uint32_t PeerReferencesFeature = 1;
+
+            struct State
+            {
+                std::atomic<std::uint32_t> m_descriptor{ 0 };
+                std::atomic<std::uint32_t> m_mode{ Undecided };
+                std::atomic<std::uint32_t> m_features{ 0 };
+            };
+
+            static std::uint32_t MakeDescriptor(bond::ProtocolType protocol)
+            {
+                return (Version << 16) | static_cast<std::uint16_t>(protocol);
+            }
+
+            const std::uint32_t m_descriptor;
+            std::shared_ptr<SharedMemory> m_inputMemory;
+            std::shared_ptr<SharedMemory> m_outputMemory;
+            State& m_local;
+            std::atomic<std::uint32_t> m_remoteMode{ Undecided };
+            std::atomic_bool m_isHeaderlessDisabled{ false };
+        };
+
+
+        template <typename Serializer>
+        auto NegotiateProtocol(Serializer& serializer, int) -> decltype(serializer.Negotiate(), void())
+        {
+            serializer.Negotiate();
+        }
+
+        template <typename Serializer>
+        void NegotiateProtocol(Serializer& /*serializer*/, long)
+        {}
+
+        // Enables negotiation for serializers supporting it, must be called once per connection before any copies are made.
+        template <typename Serializer>
+        void NegotiateProtocol(Serializer& serializer)
+        {
+            NegotiateProtocol(serializer, 0);
+        }
+
+
+        template <typename Serializer>
+        auto DisableHeaderless(Serializer& serializer, int) -> decltype(serializer.DisableHeaderless())
+        {
+            return serializer.DisableHeaderless();
+        }
+
+        template <typename Serializer>
+        bool DisableHeaderless(Serializer& /*serializer*/, long)
+        {
+            return true;
+        }
+
+        // Returns false when the connection may already exchange messages without the marshaling header.
+        template <typename Serializer>
+        bool DisableHeaderless(Serializer& serializer)
+        {
+            return DisableHeaderless(serializer, 0);
+        }
+
+    } // detail
+} // Bond
+} // IPC
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <bond/core/reflection.h>
+#include <initializer_list>
+
+
+namespace IPC
+{
+namespace Bond
+{
+    namespace detail
+    {
+        template <typename T>
+        using Schema = typename bond::schema<T>::type;
+
+        template <typename Fields>
+        struct FieldList;
+
+        template <template <typename...> typename List, typename... Fields>
+        struct FieldList<List<Fields...>>
+        {
+            template <typename Function>
+            static void ForEach(Function&& func)
+            {
+                (void)std::initializer_list<int>{ ((void)func(Fields{}), 0)... };
+            }
+        };
+
+        template <typename T>
+        using Fields = FieldList<typename Schema<T>::fields>;
+
+
+        template <typename T>
+        const T& GetDefault()
+        {
+            static const T s_default{};
+            return s_default;
+        }
+
+    } // detail
+} // Bond
+} // IPC
@@ -0,0 +1,332 @@
+// Built into its own executable (IPC.Bond.AllocationTests), since it replaces the global operator new.
+#include "stdafx.h"
+#include "IPC/Bond/InplaceTraits.h"
+#include "IPC/Bond/Serializer.h"
+#include "IPC/Bond/Transport.h"
+#include "IPC/detail/RandomString.h"
+#include <bond/core/bond_types.h>
+#include <atomic>
+#include <cstdlib>
+#include <future>
+#include <new>
+#include <thread>
+
+using namespace IPC::Bond;
+using IPC::detail::GenerateRandomString;
+using IPC::SharedMemory;
+using IPC::create_only;
+
+
+namespace
+{
+    std::atomic_bool s_isCounting{ false };
+    std::atomic<std::size_t> s_allocationCount{ 0 };
+
+    // Counts the heap allocations made by all threads during its lifetime, so the delivery threads
+    // of the transport are included.
+    class AllocationCounter
+    {
+    public:
+        AllocationCounter()
+        {
+            s_allocationCount = 0;
+            s_isCounting = true;
+        }
+
+        AllocationCounter(const AllocationCounter& other) = delete;
+        AllocationCounter& operator=(const AllocationCounter& other) = delete;
+
+        ~AllocationCounter()
+        {
+            s_isCounting = false;
+        }
+
+        std::size_t GetCount() const
+        {
+            return s_allocationCount;
+        }
+    };
+
+} // anonymous
+
+
+// Array and nothrow forms forward to these by default.
+void* operator new(std::size_t size)
+{
+    if (s_isCounting.load(std::memory_order_relaxed))
+    {
+        s_allocationCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (auto ptr = std::malloc(size != 0 ? size : 1))
+    {
+        return ptr;
+    }
+
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t /*size*/) noexcept
+{
+    std::free(ptr);
+}
+
+
+BOOST_AUTO_TEST_SUITE(AllocationTests)
+
+using Request = bond::Box<std::uint64_t>;
+using Response = bond::Box<bond::blob>;
+
+// Both ends of a connection, each writing to its own memory.
+struct Connection
+{
+    explicit Connection(bool marshal)
+        : m_clientPool{ std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024)) },
+          m_serverPool{ std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024)) },
+          m_client{ bond::ProtocolType::COMPACT_PROTOCOL, marshal, m_clientPool, m_serverPool->GetMemory() },
+          m_server{ bond::ProtocolType::COMPACT_PROTOCOL, marshal, m_serverPool, m_clientPool->GetMemory() }
+    {
+        m_client.Negotiate();
+        m_server.Negotiate();
+
+        auto blob = m_serverPool->TakeBlob();
+        blob->resize(1024, 'x');
+        m_response.value = BlobCast(DefaultBufferPool::ConstBlob{ std::move(blob) }, m_serverPool->GetMemory());
+    }
+
+    std::shared_ptr<DefaultBufferPool> m_clientPool;
+    std::shared_ptr<DefaultBufferPool> m_serverPool;
+    DefaultSerializer m_client;
+    DefaultSerializer m_server;
+    Response m_response;
+};
+
+template <typename Function>
+std::size_t CountAllocations(Function&& func)
+{
+    constexpr std::size_t warmUp = 10;
+    constexpr std::size_t iterations = 100;
+
+    for (std::size_t i = 0; i < warmUp; ++i)
+    {
+        func();
+    }
+
+    AllocationCounter counter;
+
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        func();
+    }
+
+    return counter.GetCount();
+}
+
+BOOST_AUTO_TEST_CASE(CounterTest)
+{
+    AllocationCounter counter;
+    auto value = std::make_unique<int>();
+    BOOST_TEST(counter.GetCount() == 1);
+}
+
+BOOST_AUTO_TEST_CASE(RoundTripTest)
+{
+    for (auto marshal : { false, true })
+    {
+        Connection connection{ marshal };
+
+        Request request, receivedRequest;
+        Response receivedResponse;
+
+        auto count = CountAllocations(
+            [&]
+            {
+                ++request.value;
+
+                connection.m_server.Deserialize(connection.m_client.Serialize(request), receivedRequest);
+                connection.m_client.Deserialize(connection.m_server.Serialize(connection.m_response), receivedResponse);
+            });
+
+        BOOST_TEST(count == 0);
+        BOOST_TEST((receivedRequest == request));
+        BOOST_TEST((receivedResponse == connection.m_response));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(FutureRoundTripTest)
+{
+    Connection connection{ true };
+
+    Response receivedResponse;
+
+    auto count = CountAllocations(
+        [&]
+        {
+            connection.m_server.Deserialize<Request>(connection.m_client.Serialize(Request{})).get();
+            receivedResponse = connection.m_client.Deserialize<Response>(connection.m_server.Serialize(connection.m_response)).get();
+        });
+
+    BOOST_TEST(count == 0);
+    BOOST_TEST((receivedResponse == connection.m_response));
+}
+
+struct TransportTraits : DefaultTraits
+{
+    using TimeoutFactory = IPC::Policies::InfiniteTimeoutFactory;   // Using no-timeout to make these tests reliable.
+
+    template <typename Context>
+    using TransactionManager = IPC::Policies::TransactionManager<Context, TimeoutFactory>;
+
+    // NoObjectPool allocates every deserialized object.
+    template <typename T>
+    using ObjectPool = RecyclingObjectPool<T>;
+};
+
+// Keeps the transaction callbacks out of the heap.
+using Traits = InplaceCallbackTraits<TransportTraits>;
+
+using ConstBuffer = DefaultBufferPool::ConstBuffer;
+
+// Completion of a call, waited for by spinning so that waiting makes no allocation.
+class Completion
+{
+public:
+    void Set()
+    {
+        m_isSet.store(true, std::memory_order_release);
+    }
+
+    void Wait()
+    {
+        while (!m_isSet.exchange(false, std::memory_order_acquire))
+        {
+            std::this_thread::yield();
+        }
+    }
+
+private:
+    std::atomic_bool m_isSet{ false };
+};
+
+struct IncrementHandler
+{
+    template <typename Callback>
+    void operator()(Request&& request, Callback&& callback)
+    {
+        ++request.value;
+        callback(request);
+    }
+
+    template <typename Callback>
+    void operator()(std::exception_ptr /*error*/, Callback&& /*callback*/)
+    {}
+};
+
+struct ResponseCallback
+{
+    void operator()(Request&& response)
+    {
+        *m_response = response;
+        m_completion->Set();
+    }
+
+    void operator()(std::exception_ptr /*error*/)
+    {
+        m_completion->Set();    // The response is left unchanged.
+    }
+
+    Request* m_response;
+    Completion* m_completion;
+};
+
+// Round trips of the IPC transport alone, echoing a pooled buffer. Allocations made here are not
+// under the control of IPC.Bond and are reported separately.
+std::size_t CountTransportAllocations(IPC::Bond::Transport<Request, Request, Traits>& transport)
+{
+    using RawServer = IPC::Server<ConstBuffer, ConstBuffer, Traits>;
+
+    auto name = GenerateRandomString();
+
+    std::promise<std::unique_ptr<RawServer>> server;
+
+    auto acceptor = transport.MakeServerAcceptor(
+        name.c_str(),
+        [&](auto futureConnection)
+        {
+            auto connection = futureConnection.get();
+            auto pool = detail::MakeBufferPoolHolder<DefaultBufferPool>(*connection).GetOutputPool();
+
+            server.set_value(std::make_unique<RawServer>(
+                std::move(connection),
+                [pool](ConstBuffer&& request, auto&& callback) { callback(CopyBuffer(request, *pool)); },
+                [] {}));
+        });
+
+    auto connection = transport.MakeClientConnector().Connect(name.c_str()).get();
+    auto pool = detail::MakeBufferPoolHolder<DefaultBufferPool>(*connection).GetOutputPool();
+
+    IPC::Client<ConstBuffer, ConstBuffer, Traits> client{ std::move(connection), [] {} };
+    auto serverHolder = server.get_future().get();
+
+    auto blob = pool->TakeBlob();
+    blob->resize(sizeof(Request), 'x');
+    auto buffer = pool->TakeBuffer();
+    buffer->push_back(std::move(blob));
+    const ConstBuffer request{ std::move(buffer) };
+
+    Completion completion;
+
+    return CountAllocations(
+        [&]
+        {
+            client(ConstBuffer{ request }, [&](ConstBuffer&& /*response*/) { completion.Set(); });
+            completion.Wait();
+        });
+}
+
+BOOST_AUTO_TEST_CASE(ClientServerRoundTripTest)
+{
+    using Transport = IPC::Bond::Transport<Request, Request, Traits>;
+
+    Transport transport;
+
+    auto transportCount = CountTransportAllocations(transport);
+
+    auto name = GenerateRandomString();
+
+    std::promise<std::unique_ptr<Transport::Server>> server;
+
+    auto acceptor = transport.MakeServerAcceptor(
+        name.c_str(),
+        [&](auto futureConnection)
+        {
+            server.set_value(transport.MakeServer(futureConnection.get(), [](auto&&...) { return IncrementHandler{}; }, [] {}));
+        });
+
+    auto client = transport.MakeClient(transport.MakeClientConnector().Connect(name.c_str()).get(), [] {});
+    auto serverHolder = server.get_future().get();
+
+    Request request, response;
+    Completion completion;
+
+    auto count = CountAllocations(
+        [&]
+        {
+            ++request.value;
+            (*client)(request, ResponseCallback{ &response, &completion });
+            completion.Wait();
+        });
+
+    BOOST_TEST_MESSAGE("Round trip allocations: " << count << ", transport alone: " << transportCount << ".");
+
+    // Counted on the calling and the delivery threads, IPC.Bond adds none on top of the transport.
+    BOOST_TEST(count <= transportCount);
+    BOOST_TEST(response.value == request.value + 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
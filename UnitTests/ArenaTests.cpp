@@ -0,0 +1,180 @@
+#include "stdafx.h"
+#include "IPC/Bond/Arena.h"
+#include "IPC/Bond/Serializer.h"
+#include "IPC/detail/RandomString.h"
+#include <bond/core/bond.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace IPC::Bond;
+using IPC::detail::GenerateRandomString;
+using IPC::SharedMemory;
+using IPC::create_only;
+
+
+BOOST_AUTO_TEST_SUITE(ArenaTests)
+
+struct Message
+{
+    using allocator_type = ArenaAllocator<char>;
+    using String = std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+
+    explicit Message(const allocator_type& allocator = {})
+        : m_string{ allocator },
+          m_strings{ allocator }
+    {}
+
+    String m_string;
+    std::vector<String, ArenaAllocator<String>> m_strings;
+
+    // Mirrors the code generated by gbc --allocator for: struct Message { 0: string m_string; 1: vector<string> m_strings; }
+    struct Schema
+    {
+        typedef bond::no_base base;
+
+        static const bond::Metadata metadata;
+
+    private:
+        static const bond::Metadata s_m_string_metadata;
+        static const bond::Metadata s_m_strings_metadata;
+
+    public:
+        struct var
+        {
+            typedef struct m_string_type : bond::reflection::FieldTemplate<
+                0,
+                bond::reflection::optional_field_modifier,
+                Message,
+                String,
+                &Message::m_string,
+                &s_m_string_metadata
+            > {} m_string;
+
+            typedef struct m_strings_type : bond::reflection::FieldTemplate<
+                1,
+                bond::reflection::optional_field_modifier,
+                Message,
+                std::vector<String, ArenaAllocator<String>>,
+                &Message::m_strings,
+                &s_m_strings_metadata
+            > {} m_strings;
+        };
+
+        typedef bond::detail::mpl::list<var::m_string, var::m_strings> fields;
+
+        static bond::Metadata GetMetadata()
+        {
+            return bond::reflection::MetadataInit("Message", "UnitTests.Message", bond::reflection::Attributes());
+        }
+    };
+};
+
+const bond::Metadata Message::Schema::metadata = Message::Schema::GetMetadata();
+
+const bond::Metadata Message::Schema::s_m_string_metadata =
+    bond::reflection::MetadataInit("m_string", bond::reflection::optional_field_modifier::value, bond::reflection::Attributes());
+
+const bond::Metadata Message::Schema::s_m_strings_metadata =
+    bond::reflection::MetadataInit("m_strings", bond::reflection::optional_field_modifier::value, bond::reflection::Attributes());
+
+BOOST_AUTO_TEST_CASE(MonotonicArenaTest)
+{
+    MonotonicArena arena{ 64 };
+    BOOST_TEST(arena.GetReservedSize() == 0);
+
+    arena.Allocate(3, 1);
+    auto ptr = arena.Allocate(8, 8);
+    BOOST_TEST(reinterpret_cast<std::uintptr_t>(ptr) % 8 == 0);
+    BOOST_TEST(arena.GetAllocatedSize() == 11);
+
+    arena.Allocate(1024);
+    auto reserved = arena.GetReservedSize();
+    BOOST_TEST(reserved >= 1024 + 64);
+
+    arena.Reset();
+    BOOST_TEST(arena.GetAllocatedSize() == 0);
+
+    arena.Allocate(3, 1);
+    arena.Allocate(1024);
+    BOOST_TEST(arena.GetReservedSize() == reserved);
+}
+
+BOOST_AUTO_TEST_CASE(ArenaAllocatorTest)
+{
+    MonotonicArena arena;
+
+    std::vector<int, ArenaAllocator<int>> values{ ArenaAllocator<int>{ arena } };
+    values.resize(100);
+    BOOST_TEST(arena.GetAllocatedSize() >= 100 * sizeof(int));
+
+    std::vector<int, ArenaAllocator<int>> heapValues;
+    heapValues.resize(100);
+    BOOST_TEST(!heapValues.get_allocator().GetArena());
+
+    BOOST_TEST((ArenaAllocator<char>{ arena } == ArenaAllocator<int>{ arena }));
+    BOOST_TEST((ArenaAllocator<char>{ arena } != ArenaAllocator<char>{}));
+}
+
+BOOST_AUTO_TEST_CASE(ArenaObjectPoolTest)
+{
+    ArenaObjectPool<Message, 1, 1024> pool;
+
+    const MonotonicArena* arena;
+    {
+        auto message = pool.Take();
+        arena = &message.GetArena();
+
+        message->m_string.assign(100, 'a');
+
+        for (int i = 0; i < 100; ++i)
+        {
+            message->m_strings.emplace_back(50, 'b', message->m_strings.get_allocator());
+        }
+
+        BOOST_TEST(arena->GetAllocatedSize() > 100 * 50);
+    }
+
+    BOOST_TEST(pool.GetAvailableCount() == 1);
+
+    auto message = pool.Take();
+    BOOST_TEST(&message.GetArena() == arena);
+    BOOST_TEST(arena->GetAllocatedSize() == 0);
+    BOOST_TEST(message->m_strings.empty());
+}
+
+BOOST_AUTO_TEST_CASE(DeserializeTest)
+{
+    auto memory = std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024);
+    DefaultSerializer serializer{ bond::ProtocolType::COMPACT_PROTOCOL, false, std::make_shared<DefaultBufferPool>(memory), memory };
+
+    Message source;
+    source.m_string.assign(100, 'a');
+
+    for (int i = 0; i < 10; ++i)
+    {
+        source.m_strings.emplace_back(50, 'b');
+    }
+
+    ArenaObjectPool<Message, 1, 1024> pool;
+
+    const MonotonicArena* arena;
+    {
+        auto message = pool.Take();
+        arena = &message.GetArena();
+
+        serializer.Deserialize(serializer.Serialize(source), *message);
+
+        BOOST_TEST((message->m_string == source.m_string));
+        BOOST_TEST((message->m_strings == source.m_strings));
+
+        // Nested strings are allocated from the arena as well.
+        BOOST_TEST(message->m_strings.front().get_allocator().GetArena() == arena);
+        BOOST_TEST(arena->GetAllocatedSize() >= 100 + 10 * 50);
+    }
+
+    BOOST_TEST(pool.GetAvailableCount() == 1);
+    BOOST_TEST(arena->GetAllocatedSize() == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -2,8 +2,11 @@
 #include "IPC/Bond/BlobCast.h"
 #include "IPC/SharedMemory.h"
 #include "IPC/detail/RandomString.h"
+#include <algorithm>
 #include <array>
 #include <memory>
+#include <thread>
+#include <vector>
 
 using namespace IPC::Bond;
 using IPC::detail::GenerateRandomString;
@@ -126,4 +129,77 @@ BOOST_AUTO_TEST_CASE(CastFromIncorrectBondBlobTest)
     BOOST_TEST(!mock);
 }
 
+BOOST_AUTO_TEST_CASE(CastCacheTest)
+{
+    auto memory = std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024);
+
+    auto& data = memory->Construct<std::array<char, 6>>(anonymous_instance);
+    std::strcpy(data.data(), "Data!");
+
+    BlobCastCache<BlobMock> cast;
+
+    auto blob = BlobCast(BlobMock{ data.data(), data.size() }, memory);
+
+    BlobMock mock1 = cast(blob.range(1));
+    BlobMock mock2 = cast(blob.range(3));
+
+    BOOST_TEST(mock1.data() == data.data() + 1);
+    BOOST_TEST(mock1.size() == data.size() - 1);
+    BOOST_TEST(mock2.data() == data.data() + 3);
+    BOOST_TEST(mock2.size() == data.size() - 3);
+
+    const char other[] = "Data";
+    BOOST_TEST(!cast(bond::blob{ other, sizeof(other) }));
+    BOOST_TEST(!cast(bond::blob{}));
+
+    BOOST_TEST(cast(blob).data() == data.data());
+}
+
+BOOST_AUTO_TEST_CASE(PooledHolderReuseTest)
+{
+    using Pool = detail::FixedSizePool<64, alignof(std::max_align_t)>;
+
+    auto block = Pool::Allocate();
+    Pool::Deallocate(block);
+
+    BOOST_TEST(Pool::Allocate() == block);
+    Pool::Deallocate(block);
+}
+
+BOOST_AUTO_TEST_CASE(PooledHolderCrossThreadTest)
+{
+    using Pool = detail::FixedSizePool<48, alignof(std::max_align_t), 4>;
+
+    std::vector<void*> blocks;
+
+    for (int i = 0; i < 8; ++i)
+    {
+        blocks.push_back(Pool::Allocate());
+    }
+
+    void* reused = nullptr;
+
+    std::thread{ [&]
+    {
+        for (auto block : blocks)
+        {
+            Pool::Deallocate(block);
+        }
+
+        reused = Pool::Allocate();  // Returned blocks are not served to the releasing thread.
+        Pool::Deallocate(reused);
+    } }.join();
+
+    BOOST_TEST((std::find(blocks.begin(), blocks.end(), reused) == blocks.end()));
+
+    auto block = Pool::Allocate();  // Reclaims the returned blocks.
+    BOOST_TEST((std::find(blocks.begin(), blocks.end(), block) != blocks.end()));
+    Pool::Deallocate(block);
+
+    void* orphan = nullptr;
+    std::thread{ [&] { orphan = Pool::Allocate(); } }.join();
+
+    Pool::Deallocate(orphan);       // Released after the owning thread exited.
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -1,11 +1,17 @@
 #include "stdafx.h"
 #include "IPC/Bond/BufferPool.h"
 #include "IPC/detail/RandomString.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
 
 using namespace IPC::Bond;
 using IPC::detail::GenerateRandomString;
 using IPC::SharedMemory;
 using IPC::create_only;
+using IPC::anonymous_instance;
 
 
 BOOST_AUTO_TEST_SUITE(BufferPoolTests)
@@ -211,4 +217,287 @@ BOOST_AUTO_TEST_CASE(ConstBufferRangeTest)
     }
 }
 
+BOOST_AUTO_TEST_CASE(CopyBufferTest)
+{
+    auto pool = std::make_unique<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+    auto otherPool = std::make_unique<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+
+    BOOST_TEST(CopyBuffer(DefaultBufferPool::ConstBuffer{}, *pool).size() == 0);
+
+    auto buffer = otherPool->TakeBuffer();
+    {
+        auto blob = otherPool->TakeBlob();
+        blob->resize(100, boost::container::default_init);
+        std::fill(blob->begin(), blob->end(), 'a');
+        buffer->push_back(std::move(blob));
+    }
+    buffer->push_back(otherPool->TakeBlob());
+    DefaultBufferPool::ConstBuffer constBuffer{ std::move(buffer) };
+
+    auto copy = CopyBuffer(constBuffer, *pool);
+    BOOST_TEST(copy.size() == 100);
+    BOOST_TEST(!(copy == constBuffer));
+    BOOST_TEST((std::next(copy.begin()) == copy.end()));
+    BOOST_TEST(pool->GetMemory()->Contains(copy.begin()->data()));
+    BOOST_TEST(std::all_of(copy.begin()->begin(), copy.begin()->end(), [](char c) { return c == 'a'; }));
+
+    auto same = CopyBuffer(copy, *pool);
+    BOOST_TEST(same.begin()->data() == copy.begin()->data());
+}
+
+BOOST_AUTO_TEST_CASE(PeerReferenceTest)
+{
+    auto pool = std::make_unique<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+    auto peerPool = std::make_unique<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+
+    auto makeBlob = [](DefaultBufferPool& pool, std::size_t size, char c)
+    {
+        auto blob = pool.TakeBlob();
+        blob->resize(size, boost::container::default_init);
+        std::fill(blob->begin(), blob->end(), c);
+        return DefaultBufferPool::ConstBlob{ blob };
+    };
+
+    auto large = makeBlob(*peerPool, 100, 'a');
+    auto small = makeBlob(*peerPool, 10, 'b');
+
+    BOOST_TEST(!pool->MakeReference(large));
+
+    pool->EnablePeerReferences(peerPool->GetMemory(), 50);
+    BOOST_TEST(!pool->MakeReference(large));    // The peer does not resolve references.
+
+    detail::ProtocolNegotiation::AdvertisePeerReferences(*peerPool->GetMemory());
+
+    BOOST_TEST(!pool->MakeReference(small));
+    BOOST_TEST(!pool->MakeReference(makeBlob(*pool, 100, 'c')));
+
+    auto reference = pool->MakeReference(large.GetRange(10, 80));
+    BOOST_TEST(!!reference);
+    BOOST_TEST(reference.IsReference());
+    BOOST_TEST(pool->GetMemory()->Contains(reference.data()));
+
+    auto buffer = pool->TakeBuffer();
+    buffer->push_back(makeBlob(*pool, 5, 'd'));
+    buffer->push_back(std::move(reference));
+    DefaultBufferPool::ConstBuffer constBuffer{ std::move(buffer) };
+
+    BOOST_CHECK_THROW(CopyBuffer(constBuffer, *peerPool), std::exception);
+    BOOST_TEST(!peerPool->ResolveReferences(DefaultBufferPool::ConstBuffer{ peerPool->TakeBuffer() }));
+
+    auto resolved = peerPool->ResolveReferences(constBuffer);
+    BOOST_TEST(!!resolved);
+    BOOST_TEST(resolved.size() == 85);
+    BOOST_TEST(resolved.begin()->data() == constBuffer.begin()->data());    // Linked, not copied.
+    BOOST_TEST(std::next(resolved.begin())->data() == large.data() + 10);
+    BOOST_TEST(std::all_of(std::next(resolved.begin())->begin(), std::next(resolved.begin())->end(), [](char c) { return c == 'a'; }));
+}
+
+BOOST_AUTO_TEST_CASE(PeerReferencePinTest)
+{
+    auto pool = std::make_unique<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 4 * 1024 * 1024));
+    auto peerPool = std::make_unique<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 4 * 1024 * 1024));
+    pool->EnablePeerReferences(peerPool->GetMemory(), 0);
+    detail::ProtocolNegotiation::AdvertisePeerReferences(*peerPool->GetMemory());
+
+    auto pinned = [&]
+    {
+        auto blob = peerPool->TakeBlob();
+        blob->resize(100, boost::container::default_init);
+        return DefaultBufferPool::ConstBlob{ blob };
+    }();
+
+    {
+        auto reference = pool->MakeReference(pinned);
+        BOOST_TEST(!!reference);
+        BOOST_TEST(!pinned.IsUnique());
+    }
+
+    // Released once the reference blob is freed and the pool is used again.
+    pool->TakeBlob();
+    BOOST_TEST(pinned.IsUnique());
+
+    // Outstanding pins are bounded, blobs are copied instead.
+    std::vector<DefaultBufferPool::ConstBlob> references;
+
+    while (auto reference = pool->MakeReference(pinned))
+    {
+        references.push_back(std::move(reference));
+    }
+
+    BOOST_TEST(!references.empty());
+
+    references.clear();
+    pool->TakeBlob();
+    BOOST_TEST(pinned.IsUnique());
+    BOOST_TEST(!!pool->MakeReference(pinned));
+}
+
+BOOST_AUTO_TEST_CASE(BlobAlignmentTest)
+{
+    auto memory = std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024);
+    DefaultBufferPool pool{ memory };
+
+    auto isAligned = [](const void* ptr) { return reinterpret_cast<std::uintptr_t>(ptr) % 64 == 0; };
+
+    {
+        // The memory behind the only blob is free, so it grows in place.
+        auto blob = pool.TakeBlob();
+        blob->resize(100, boost::container::default_init);
+        auto data = blob->data();
+
+        blob->resize(10000, boost::container::default_init);
+        BOOST_TEST((blob->data() == data));
+        BOOST_TEST(isAligned(blob->data()));
+    }
+
+    std::vector<DefaultBufferPool::Blob> blobs;
+
+    for (std::size_t size = 1; size < 10000; size = size * 3 + 1)
+    {
+        auto blob = pool.TakeBlob();
+        blob->resize(size, boost::container::default_init);
+        BOOST_TEST(isAligned(blob->data()));
+
+        // Grows in place or through reallocation.
+        blob->resize(size * 2 + 100, boost::container::default_init);
+        BOOST_TEST(isAligned(blob->data()));
+
+        blobs.push_back(std::move(blob));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(LifoQueueTest)
+{
+    auto memory = std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024);
+    LifoBufferPool pool{ memory };
+
+    const void* firstPtr;
+    const void* secondPtr;
+    {
+        auto first = pool.TakeBlob();
+        auto second = pool.TakeBlob();
+        firstPtr = &*first;
+        secondPtr = &*second;
+    }
+
+    // Released in reverse order at the scope exit, the last released blob is reused first.
+    auto blob = pool.TakeBlob();
+    BOOST_TEST(&*blob == firstPtr);
+    BOOST_TEST(&*pool.TakeBlob() == secondPtr);
+
+    auto buffer = pool.TakeBuffer();
+    buffer->push_back(std::move(blob));
+    LifoBufferPool::ConstBuffer constBuffer{ std::move(buffer) };
+    BOOST_TEST(memory->Contains(&*constBuffer.begin()));
+}
+
+BOOST_AUTO_TEST_CASE(LockFreeStackStressTest)
+{
+    using Stack = detail::LockFreeStack<std::uint64_t, SharedMemory::Allocator<char>>;
+
+    constexpr std::uint64_t threadCount = 4;
+    constexpr std::uint64_t count = 100000;
+
+    auto memory = std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024);
+    auto stack = memory->MakeShared<Stack>(anonymous_instance, memory->GetAllocator<char>());
+
+    std::vector<std::vector<std::uint64_t>> popped(threadCount);
+    std::vector<std::thread> threads;
+
+    for (std::uint64_t i = 0; i < threadCount; ++i)
+    {
+        threads.emplace_back(
+            [&, i]
+            {
+                for (std::uint64_t j = 0; j < count; ++j)
+                {
+                    stack->Push((i << 32) | j);
+
+                    // Pops two values after every other push, so nodes keep cycling through the free list.
+                    if (j % 2 != 0)
+                    {
+                        for (int k = 0; k < 2; ++k)
+                        {
+                            if (auto value = stack->Pop())
+                            {
+                                popped[i].push_back(*value);
+                            }
+                        }
+                    }
+                }
+            });
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    while (auto value = stack->Pop())
+    {
+        popped.front().push_back(*value);
+    }
+
+    BOOST_TEST(stack->IsEmpty());
+
+    std::vector<std::uint64_t> values, expected;
+
+    for (std::uint64_t i = 0; i < threadCount; ++i)
+    {
+        values.insert(values.end(), popped[i].begin(), popped[i].end());
+
+        for (std::uint64_t j = 0; j < count; ++j)
+        {
+            expected.push_back((i << 32) | j);
+        }
+    }
+
+    // Every pushed value is popped exactly once.
+    std::sort(values.begin(), values.end());
+    BOOST_TEST((values == expected));
+}
+
+// Compares FIFO and LIFO reuse for steady traffic over a pool which has grown past the cache during a burst,
+// run explicitly with --run_test=BufferPoolTests/QueueBenchmark. Cache miss rates are best observed by running
+// it under a profiler, e.g. perf stat -e L1-dcache-load-misses,LLC-load-misses.
+BOOST_AUTO_TEST_CASE(QueueBenchmark, *boost::unit_test::disabled())
+{
+    constexpr std::size_t blobSize = 16 * 1024;
+    constexpr std::size_t burst = 4096;
+    constexpr std::size_t iterations = 100000;
+
+    auto measure = [&](auto pool)
+    {
+        {
+            std::vector<decltype(pool.TakeBlob())> blobs;
+
+            for (std::size_t i = 0; i < burst; ++i)
+            {
+                blobs.push_back(pool.TakeBlob());
+                blobs.back()->resize(blobSize, boost::container::default_init);
+            }
+        }
+
+        auto start = std::chrono::steady_clock::now();
+
+        for (std::size_t i = 0; i < iterations; ++i)
+        {
+            // Request and response.
+            auto request = pool.TakeBlob();
+            request->resize(blobSize, boost::container::default_init);
+            std::fill(request->begin(), request->end(), static_cast<char>(i));
+
+            auto response = pool.TakeBlob();
+            response->assign(request->begin(), request->end());
+        }
+
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / iterations;
+    };
+
+    auto fifo = measure(DefaultBufferPool{ std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 128 * 1024 * 1024) });
+    auto lifo = measure(LifoBufferPool{ std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 128 * 1024 * 1024) });
+
+    BOOST_TEST_MESSAGE("FIFO: " << fifo << "ns, LIFO: " << lifo << "ns per round trip of " << blobSize << " byte blobs.");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,232 @@
+#include "stdafx.h"
+#include "IPC/Bond/ChunkedStream.h"
+#include "IPC/detail/RandomString.h"
+#include <bond/core/bond_types.h>
+#include <bond/protocol/compact_binary.h>
+#include <algorithm>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace IPC::Bond;
+using IPC::detail::GenerateRandomString;
+using IPC::SharedMemory;
+using IPC::create_only;
+
+
+BOOST_AUTO_TEST_SUITE(ChunkedStreamTests)
+
+using ConstBuffer = DefaultBufferPool::ConstBuffer;
+
+BOOST_AUTO_TEST_CASE(MessageLargerThanMemoryTest)
+{
+    constexpr std::size_t memorySize = 4 * 1024 * 1024;
+
+    auto pool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), memorySize));
+
+    bond::Box<std::vector<std::string>> message;
+
+    for (std::size_t i = 0; i < 3200; ++i)
+    {
+        message.value.emplace_back(10 * 1024, static_cast<char>('a' + i % 26));
+    }
+
+    std::promise<std::shared_ptr<ChunkQueue<ConstBuffer>>> stream;
+
+    ChunkedStreamReceiver<ConstBuffer> receiver{
+        [&](std::shared_ptr<ChunkQueue<ConstBuffer>> queue) { stream.set_value(std::move(queue)); } };
+
+    auto sender = std::async(
+        std::launch::async,
+        [&]
+        {
+            return StreamSerialize<bond::CompactBinaryWriter>(pool, message, receiver, 64 * 1024, 256 * 1024);
+        });
+
+    bond::Box<std::vector<std::string>> result;
+    StreamDeserialize<bond::CompactBinaryReader>(ChunkedInputBuffer<ConstBuffer>{ stream.get_future().get(), pool->GetMemory() }, result);
+
+    sender.get();
+
+    BOOST_TEST(result.value.size() == message.value.size());
+    BOOST_TEST((result == message));
+}
+
+BOOST_AUTO_TEST_CASE(BlobLargerThanMemoryTest)
+{
+    constexpr std::size_t chunkSize = 64 * 1024;
+
+    auto pool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+
+    // Allocated on the heap, so it cannot be shared and has to be copied over chunks.
+    std::vector<char> data(3 * 1024 * 1024);
+
+    for (std::size_t i = 0; i < data.size(); ++i)
+    {
+        data[i] = static_cast<char>(i % 251);
+    }
+
+    bond::Box<bond::blob> message;
+    message.value.assign(data.data(), static_cast<std::uint32_t>(data.size()));
+
+    std::promise<std::shared_ptr<ChunkQueue<ConstBuffer>>> stream;
+
+    ChunkedStreamReceiver<ConstBuffer> receiver{
+        [&](std::shared_ptr<ChunkQueue<ConstBuffer>> queue) { stream.set_value(std::move(queue)); } };
+
+    std::size_t maxChunkSize = 0;
+
+    auto sender = std::async(
+        std::launch::async,
+        [&]
+        {
+            return StreamSerialize<bond::CompactBinaryWriter>(
+                pool,
+                message,
+                [&](ConstBuffer&& packet)
+                {
+                    maxChunkSize = (std::max)(maxChunkSize, packet.size() - sizeof(detail::ChunkedStream::Header));
+                    receiver(std::move(packet));
+                },
+                chunkSize,
+                256 * 1024);
+        });
+
+    bond::Box<bond::blob> result;
+    StreamDeserialize<bond::CompactBinaryReader>(ChunkedInputBuffer<ConstBuffer>{ stream.get_future().get(), pool->GetMemory() }, result);
+
+    sender.get();
+
+    BOOST_TEST(maxChunkSize <= chunkSize);
+    BOOST_TEST(result.value.size() == data.size());
+    BOOST_TEST(std::equal(data.begin(), data.end(), result.value.content()));
+}
+
+BOOST_AUTO_TEST_CASE(FlowControlTest)
+{
+    auto pool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 4 * 1024 * 1024));
+
+    std::vector<ConstBuffer> packets;
+
+    ChunkedOutputBuffer<DefaultBufferPool> output{
+        pool,
+        [&](ConstBuffer&& packet) { packets.push_back(std::move(packet)); },
+        32 * 1024,
+        128 * 1024,
+        std::chrono::milliseconds{ 100 } };
+
+    const std::vector<char> data(32 * 1024, 'x');
+
+    // Nobody consumes the chunks, so writing stops once the window is exhausted.
+    BOOST_CHECK_THROW(
+        {
+            for (int i = 0; i < 100; ++i)
+            {
+                output.Write(data.data(), static_cast<std::uint32_t>(data.size()));
+            }
+        },
+        std::runtime_error);
+
+    BOOST_TEST(packets.size() >= 4);
+    BOOST_TEST(packets.size() <= 7);
+
+    packets.clear();
+
+    output.Write(data.data(), static_cast<std::uint32_t>(data.size()));
+    output.Finish();
+
+    BOOST_TEST(!packets.empty());
+}
+
+BOOST_AUTO_TEST_CASE(PipelineTest)
+{
+    auto pool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 4 * 1024 * 1024));
+
+    std::shared_ptr<ChunkQueue<ConstBuffer>> stream;
+
+    ChunkedStreamReceiver<ConstBuffer> receiver{
+        [&](std::shared_ptr<ChunkQueue<ConstBuffer>> queue) { stream = std::move(queue); } };
+
+    ChunkedOutputBuffer<DefaultBufferPool> output{ pool, receiver };
+
+    const std::vector<char> data(4096, 'x');
+    output.Write(std::uint64_t{ 1 });
+    output.Write(data.data(), static_cast<std::uint32_t>(data.size()));
+
+    // The first blob is handed over long before a whole chunk is written.
+    BOOST_TEST(!!stream);
+
+    ChunkedInputBuffer<ConstBuffer> input{ stream, pool->GetMemory() };
+
+    std::uint64_t value;
+    input.Read(value);
+    BOOST_TEST(value == 1);
+
+    output.Write(std::uint64_t{ 2 });
+    output.Finish();
+
+    input.Skip(static_cast<std::uint32_t>(data.size()));
+    input.Read(value);
+    BOOST_TEST(value == 2);
+    BOOST_TEST(input.IsEof());
+}
+
+BOOST_AUTO_TEST_CASE(ProtocolTest)
+{
+    auto pool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+
+    bond::Box<std::vector<std::string>> message;
+    message.value.assign(1000, "value");
+
+    for (auto protocol : { bond::ProtocolType::COMPACT_PROTOCOL, bond::ProtocolType::FAST_PROTOCOL, bond::ProtocolType::SIMPLE_PROTOCOL })
+    {
+        std::shared_ptr<ChunkQueue<ConstBuffer>> stream;
+
+        ChunkedStreamReceiver<ConstBuffer> receiver{
+            [&](std::shared_ptr<ChunkQueue<ConstBuffer>> queue) { stream = std::move(queue); } };
+
+        StreamSerialize(protocol, pool, message, receiver, 1024);
+
+        bond::Box<std::vector<std::string>> result;
+        StreamDeserialize(protocol, ChunkedInputBuffer<ConstBuffer>{ stream, pool->GetMemory() }, result);
+
+        BOOST_TEST((result == message));
+    }
+
+    BOOST_CHECK_THROW(
+        StreamSerialize(bond::ProtocolType::SIMPLE_JSON_PROTOCOL, pool, message, [](ConstBuffer&&) {}),
+        std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(CloseTest)
+{
+    auto pool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+
+    std::shared_ptr<ChunkQueue<ConstBuffer>> stream;
+
+    ChunkedStreamReceiver<ConstBuffer> receiver{
+        [&](std::shared_ptr<ChunkQueue<ConstBuffer>> queue) { stream = std::move(queue); } };
+
+    ChunkedOutputBuffer<DefaultBufferPool> output{ pool, receiver, 16 };
+
+    output.Write(std::uint64_t{ 1 });
+    output.Write(std::uint64_t{ 2 });
+    output.Write(std::uint64_t{ 3 });
+
+    BOOST_TEST(!!stream);
+
+    ChunkedInputBuffer<ConstBuffer> input{ stream, pool->GetMemory() };
+
+    std::uint64_t value;
+    input.Read(value);
+    BOOST_TEST(value == 1);
+    input.Read(value);
+    BOOST_TEST(value == 2);
+
+    receiver.Close();
+
+    BOOST_CHECK_THROW(input.Read(value), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -3,8 +3,18 @@
 #include "IPC/Bond/Client.h"
 #include "IPC/Bond/Acceptor.h"
 #include "IPC/Bond/Connector.h"
+#include "IPC/Bond/Proxy.h"
+#include "IPC/Bond/RequestCoalescer.h"
 #include "IPC/detail/RandomString.h"
+#include <bond/core/bond_types.h>
 #include <bond/core/tuple.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 using namespace IPC::Bond;
 using IPC::detail::GenerateRandomString;
@@ -40,6 +50,12 @@ public:
     template <typename T>
     void Deserialize(DefaultBufferPool::ConstBuffer&& buffer, T& value);
 
+    template <>
+    void Deserialize(DefaultBufferPool::ConstBuffer&& /*buffer*/, Request& /*value*/)
+    {
+        ++m_counters->m_requestDeserialized;
+    }
+
     template <>
     void Deserialize(DefaultBufferPool::ConstBuffer&& /*buffer*/, Response& /*value*/)
     {
@@ -167,6 +183,246 @@ BOOST_AUTO_TEST_CASE(SerializerTest)
     BOOST_TEST(server->CheckServerUsage());
 }
 
+struct ValueHandler
+{
+    template <typename Callback>
+    void operator()(Request&& request, Callback&& callback)
+    {
+        callback(std::tuple_cat(request, request));
+    }
+
+    template <typename Callback>
+    void operator()(std::exception_ptr /*error*/, Callback&& /*callback*/)
+    {
+        BOOST_FAIL("Unexpected deserialization failure.");
+    }
+};
+
+struct ValueCallback
+{
+    void operator()(Response&& response)
+    {
+        m_result->set_value(response);
+    }
+
+    void operator()(std::exception_ptr error)
+    {
+        m_result->set_exception(error);
+    }
+
+    std::shared_ptr<std::promise<Response>> m_result;
+};
+
+static_assert(detail::IsValueCallback<ValueCallback, Response>::value, "ValueCallback should receive Response by rvalue.");
+static_assert(!detail::IsValueCallback<std::function<void(std::future<Response>)>, Response>::value, "Future callbacks should be preferred.");
+
+BOOST_AUTO_TEST_CASE(ValueHandlerTest)
+{
+    auto name = GenerateRandomString();
+
+    std::unique_ptr<Server> server;
+
+    Acceptor acceptor{
+        name.c_str(),
+        [&](auto&& futureConnection)
+        {
+            server = std::make_unique<Server>(
+                detail::BufferPoolHolder<DefaultBufferPool>{ nullptr, nullptr },
+                SerializerMock{},
+                futureConnection.get(),
+                ValueHandler{},
+                [] {});
+        } };
+
+    Client client{
+        detail::BufferPoolHolder<DefaultBufferPool>{ nullptr, nullptr },
+        SerializerMock{},
+        Connector{}.Connect(name.c_str()).get(),
+        [] {},
+        {} };
+
+    auto result = std::make_shared<std::promise<Response>>();
+    client(Request{}, ValueCallback{ result });
+    BOOST_TEST((result->get_future().get() == Response{}));
+    BOOST_TEST(client.CheckClientUsage());
+    BOOST_TEST(server->CheckServerUsage());
+}
+
+BOOST_AUTO_TEST_CASE(CallerOwnedResponseTest)
+{
+    auto name = GenerateRandomString();
+
+    std::unique_ptr<Server> server;
+
+    Acceptor acceptor{
+        name.c_str(),
+        [&](auto&& futureConnection)
+        {
+            server = std::make_unique<Server>(
+                detail::BufferPoolHolder<DefaultBufferPool>{ nullptr, nullptr },
+                SerializerMock{},
+                futureConnection.get(),
+                [](std::future<Request> request, auto&& callback) { request.get(); callback(Response{}); },
+                [] {});
+        } };
+
+    Client client{
+        detail::BufferPoolHolder<DefaultBufferPool>{ nullptr, nullptr },
+        SerializerMock{},
+        Connector{}.Connect(name.c_str()).get(),
+        [] {},
+        {} };
+
+    Response response{ 1, 2 };
+    std::promise<std::exception_ptr> result;
+
+    client(Request{}, response, [&](std::exception_ptr error) { result.set_value(error); });
+    BOOST_TEST(!result.get_future().get());
+    BOOST_TEST((response == Response{}));
+    BOOST_TEST(client.CheckClientUsage());
+    BOOST_TEST(server->CheckServerUsage());
+}
+
+BOOST_AUTO_TEST_CASE(ReusedCallerOwnedResponseTest)
+{
+    using Count = bond::Box<std::uint32_t>;
+    using Payload = std::tuple<std::string, std::vector<std::int32_t>>;
+
+    auto name = GenerateRandomString();
+
+    std::unique_ptr<IPC::Bond::Server<Count, Payload>> server;
+
+    ServerAcceptor<Count, Payload> acceptor{
+        name.c_str(),
+        [&](auto&& futureConnection)
+        {
+            server = MakeServer<Count, Payload>(
+                futureConnection.get(),
+                [](auto&&...)
+                {
+                    return [](std::future<Count> request, auto&& callback)
+                    {
+                        auto count = request.get().value;
+                        callback(Payload{ std::string(count, 'a'), std::vector<std::int32_t>(count, 1) });
+                    };
+                },
+                [] {});
+        } };
+
+    auto client = MakeClient<Count, Payload>(ClientConnector<Count, Payload>{}.Connect(name.c_str()).get(), [] {});
+
+    Payload response;
+
+    for (std::uint32_t count : { 1000, 1, 0, 10 })
+    {
+        Count request;
+        request.value = count;
+
+        std::promise<std::exception_ptr> result;
+
+        (*client)(request, response, [&](std::exception_ptr error) { result.set_value(error); });
+        BOOST_TEST(!result.get_future().get());
+
+        BOOST_TEST(std::get<0>(response) == std::string(count, 'a'));
+        BOOST_TEST((std::get<1>(response) == std::vector<std::int32_t>(count, 1)));
+
+        // Filled in place, so the capacity of the first response is kept.
+        BOOST_TEST(std::get<0>(response).capacity() >= 1000);
+        BOOST_TEST(std::get<1>(response).capacity() >= 1000);
+    }
+}
+
+template <bool Enable>
+struct PeerReferenceTraits : DefaultTraits
+{
+    static constexpr bool EnablePeerReferences = Enable;
+};
+
+// Returns true when the blob echoed by the server comes back as a reference to the one the client sent.
+template <typename ClientTraits, typename ServerTraits>
+bool IsEchoReferenced()
+{
+    using Message = bond::Box<bond::blob>;
+
+    auto name = GenerateRandomString();
+
+    std::unique_ptr<IPC::Bond::Server<Message, Message, ServerTraits>> server;
+
+    ServerAcceptor<Message, Message, ServerTraits> acceptor{
+        name.c_str(),
+        [&](auto&& futureConnection)
+        {
+            server = MakeServer<Message, Message, ServerTraits>(
+                futureConnection.get(),
+                [](auto&&...) { return [](std::future<Message> request, auto&& callback) { callback(request.get()); }; },
+                [] {});
+        } };
+
+    auto client = MakeClient<Message, Message, ClientTraits>(
+        ClientConnector<Message, Message, ClientTraits>{}.Connect(name.c_str()).get(), [] {});
+
+    const std::string data(10000, 'a');
+
+    Message request;
+    request.value = bond::blob{ data.data(), static_cast<std::uint32_t>(data.size()) };
+
+    auto response = (*client)(request).get();
+    BOOST_TEST((std::string{ response.value.content(), response.value.size() } == data));
+
+    return client->GetOutputPool()->GetMemory()->Contains(response.value.content());
+}
+
+BOOST_AUTO_TEST_CASE(PeerReferenceTest)
+{
+    BOOST_TEST((IsEchoReferenced<PeerReferenceTraits<true>, PeerReferenceTraits<true>>()));
+
+    // Both sides must enable references.
+    BOOST_TEST(!(IsEchoReferenced<PeerReferenceTraits<true>, PeerReferenceTraits<false>>()));
+    BOOST_TEST(!(IsEchoReferenced<PeerReferenceTraits<false>, PeerReferenceTraits<true>>()));
+    BOOST_TEST(!(IsEchoReferenced<DefaultTraits, DefaultTraits>()));
+}
+
+struct KeyedCoalescerTraits : DefaultTraits
+{
+    using RequestCoalescer = InFlightRequestCoalescer<DefaultBufferPool, std::function<std::string(const DefaultBufferPool::ConstBuffer&)>>;
+};
+
+BOOST_AUTO_TEST_CASE(CoalescerArgumentTest)
+{
+    auto name = GenerateRandomString();
+
+    std::unique_ptr<IPC::Bond::Server<Request, Response>> server;
+
+    ServerAcceptor<Request, Response> acceptor{
+        name.c_str(),
+        [&](auto&& futureConnection)
+        {
+            server = MakeServer<Request, Response>(
+                futureConnection.get(),
+                [](auto&&...) { return [](std::future<Request> request, auto&& callback) { callback(Response{ std::get<0>(request.get()), 0 }); }; },
+                [] {});
+        } };
+
+    std::atomic_size_t extracted{ 0 };
+
+    auto client = MakeClient<Request, Response, KeyedCoalescerTraits>(
+        ClientConnector<Request, Response, KeyedCoalescerTraits>{}.Connect(name.c_str()).get(),
+        [] {},
+        bond::ProtocolType::COMPACT_PROTOCOL,
+        true,
+        0,
+        {},
+        {},
+        KeyedCoalescerTraits::RequestCoalescer{ [&](const DefaultBufferPool::ConstBuffer& /*request*/) { ++extracted; return std::string{}; } });
+
+    for (int i = 0; i < 3; ++i)
+    {
+        BOOST_TEST(std::get<0>((*client)(Request{ i }).get()) == i);
+    }
+
+    BOOST_TEST(extracted == 3);
+}
+
 BOOST_AUTO_TEST_CASE(BufferPoolTest)
 {
     auto memory = std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024);
@@ -201,4 +457,75 @@ BOOST_AUTO_TEST_CASE(BufferPoolTest)
     BOOST_TEST(server->GetOutputPool() == outPool);
 }
 
+BOOST_AUTO_TEST_CASE(ProxyTest)
+{
+    using BackendServer = IPC::Bond::Server<Request, Response>;
+    using ProxyServer = IPC::Bond::ProxyServer<Request, Response>;
+    using ProxyClient = IPC::Bond::Client<Request, Response>;
+    using ServerAcceptor = IPC::Bond::ServerAcceptor<Request, Response>;
+    using ClientConnector = IPC::Bond::ClientConnector<Request, Response>;
+
+    auto backendName = GenerateRandomString();
+    auto proxyName = GenerateRandomString();
+
+    std::unique_ptr<BackendServer> backend;
+
+    ServerAcceptor backendAcceptor{
+        backendName.c_str(),
+        [&](auto&& futureConnection)
+        {
+            backend = MakeServer<Request, Response>(futureConnection.get(), [](auto&&...) { return ValueHandler{}; }, [] {});
+        } };
+
+    auto downstream = MakeClient<Request, Response>(ClientConnector{}.Connect(backendName.c_str()).get(), [] {});
+    std::atomic<ProxyClient*> currentDownstream{ downstream.get() };
+
+    std::promise<std::exception_ptr> proxyError;
+    std::unique_ptr<ProxyServer> proxy;
+
+    ServerAcceptor proxyAcceptor{
+        proxyName.c_str(),
+        [&](auto&& futureConnection)
+        {
+            proxy = MakeProxyServer<Request, Response>(
+                futureConnection.get(),
+                [&] { return currentDownstream.load(); },
+                [] {},
+                [&](std::exception_ptr error) { proxyError.set_value(error); });
+        } };
+
+    // Both clients negotiate by default, the downstream one keeps the marshaling header since it only forwards.
+    auto client = MakeClient<Request, Response>(ClientConnector{}.Connect(proxyName.c_str()).get(), [] {});
+
+    BOOST_TEST(((*client)(Request{ 1 }).get() == Response{ 1, 1 }));
+    BOOST_TEST(((*client)(Request{ 2 }).get() == Response{ 2, 2 }));
+
+    // Downstream failure is reported by the proxy and the upstream request times out.
+    currentDownstream = nullptr;
+
+    auto response = (*client)(Request{ 3 }, std::chrono::milliseconds{ 100 });
+    BOOST_TEST(!!proxyError.get_future().get());
+    BOOST_CHECK_THROW(response.get(), std::exception);
+}
+
+BOOST_AUTO_TEST_CASE(ForwardAfterHeaderlessTest)
+{
+    auto name = GenerateRandomString();
+
+    std::unique_ptr<IPC::Bond::Server<Request, Response>> server;
+
+    ServerAcceptor<Request, Response> acceptor{
+        name.c_str(),
+        [&](auto&& futureConnection)
+        {
+            server = MakeServer<Request, Response>(futureConnection.get(), [](auto&&...) { return ValueHandler{}; }, [] {});
+        } };
+
+    auto client = MakeClient<Request, Response>(ClientConnector<Request, Response>{}.Connect(name.c_str()).get(), [] {});
+
+    // Typed calls agreed on headerless messages, which forwarded buffers would not match.
+    BOOST_TEST(((*client)(Request{ 1 }).get() == Response{ 1, 1 }));
+    BOOST_CHECK_THROW(client->Forward(DefaultBufferPool::ConstBuffer{}, [](DefaultBufferPool::ConstBuffer&& /*response*/) {}), std::logic_error);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,188 @@
+#include "stdafx.h"
+#include "IPC/Bond/Coroutine.h"
+
+// Built into its own executable (IPC.Bond.CoroutineTests) with C++20 enabled.
+#ifndef IPC_BOND_HAS_COROUTINES
+#error C++20 coroutines are required.
+#endif
+
+#include "IPC/Bond/Transport.h"
+#include "IPC/detail/RandomString.h"
+#include <bond/core/bond_types.h>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace IPC::Bond;
+
+
+BOOST_AUTO_TEST_SUITE(CoroutineTests)
+
+struct Traits : DefaultTraits
+{
+    using TimeoutFactory = IPC::Policies::InfiniteTimeoutFactory;   // Using no-timeout to make these tests reliable.
+
+    template <typename Context>
+    using TransactionManager = IPC::Policies::TransactionManager<Context, TimeoutFactory>;
+};
+
+// Blocks until the task completes, only meant for tests.
+template <typename T>
+T Wait(Task<T> task)
+{
+    std::promise<T> promise;
+    auto result = promise.get_future();
+
+    struct Callback
+    {
+        void operator()(T&& value)
+        {
+            m_promise.set_value(std::move(value));
+        }
+
+        void operator()(std::exception_ptr error)
+        {
+            m_promise.set_exception(error);
+        }
+
+        std::promise<T> m_promise;
+    };
+
+    Start(std::move(task), Callback{ std::move(promise) });
+
+    return result.get();
+}
+
+Task<int> Increment(int value)
+{
+    co_return value + 1;
+}
+
+Task<int> Accumulate(int count)
+{
+    int sum = 0;
+
+    for (int i = 0; i < count; ++i)
+    {
+        sum = co_await Increment(sum);
+    }
+
+    co_return sum;
+}
+
+Task<int> Fail()
+{
+    throw std::runtime_error{ "Failed." };
+    co_return 0;
+}
+
+BOOST_AUTO_TEST_CASE(TaskTest)
+{
+    BOOST_TEST(Wait(Accumulate(1000)) == 1000);
+    BOOST_CHECK_THROW(Wait(Fail()), std::runtime_error);
+
+    bool isCompleted = false;
+    Start([]() -> Task<> { co_return; }(), [&](std::exception_ptr error) { isCompleted = !error; });
+    BOOST_TEST(isCompleted);
+}
+
+BOOST_AUTO_TEST_CASE(ErrorHandlerTest)
+{
+    using Value = bond::Box<int>;
+
+    std::vector<std::exception_ptr> errors;
+
+    auto handler = MakeTaskHandler<Value, Value>(
+        [](Value request) -> Task<Value>
+        {
+            if (request.value < 0)
+            {
+                throw std::invalid_argument{ "Negative value." };
+            }
+
+            co_return request;
+        },
+        [&](std::exception_ptr error) { errors.push_back(error); });
+
+    std::vector<int> responses;
+    auto callback = [&](const Value& response) { responses.push_back(response.value); };
+
+    Value request;
+    request.value = -1;
+    handler(Value{ request }, callback);
+    BOOST_TEST(errors.size() == 1);
+    BOOST_CHECK_THROW(std::rethrow_exception(errors.back()), std::invalid_argument);
+
+    handler(std::make_exception_ptr(std::runtime_error{ "Invalid request." }), callback);
+    BOOST_TEST(errors.size() == 2);
+    BOOST_CHECK_THROW(std::rethrow_exception(errors.back()), std::runtime_error);
+
+    request.value = 1;
+    handler(Value{ request }, [](const Value&) { throw std::logic_error{ "Failed to send." }; });
+    BOOST_TEST(errors.size() == 3);
+    BOOST_CHECK_THROW(std::rethrow_exception(errors.back()), std::logic_error);
+
+    handler(Value{ request }, callback);
+    BOOST_TEST(errors.size() == 3);
+    BOOST_TEST(responses == std::vector<int>{ 1 });
+}
+
+BOOST_AUTO_TEST_CASE(TransportTest)
+{
+    using Transport = IPC::Bond::Transport<bond::Box<int>, bond::Box<int>, Traits>;
+
+    Transport transport;
+
+    auto name = IPC::detail::GenerateRandomString();
+
+    std::mutex lock;
+    std::condition_variable serverInserted;
+    std::unique_ptr<Transport::Server> server;
+
+    auto serverHandler = [](bond::Box<int> request) -> Task<bond::Box<int>>
+    {
+        ++request.value;
+        co_return request;
+    };
+
+    auto acceptor = transport.MakeServerAcceptor(
+        name.c_str(),
+        [&](auto futureConnection)
+        {
+            std::lock_guard<std::mutex> guard{ lock };
+            server = transport.MakeServer(futureConnection.get(), [&](auto&&...) { return serverHandler; }, [] {});
+            serverInserted.notify_one();
+        });
+
+    auto client = transport.MakeClient(transport.MakeClientConnector().Connect(name.c_str()).get(), [] {});
+
+    {
+        std::unique_lock<std::mutex> guard{ lock };
+        serverInserted.wait(guard, [&] { return !!server; });
+    }
+
+    std::thread::id resumedThread;
+
+    auto call = [&](int count) -> Task<int>
+    {
+        bond::Box<int> value;
+
+        for (int i = 0; i < count; ++i)
+        {
+            value = co_await Async(*client, value);
+        }
+
+        resumedThread = std::this_thread::get_id();
+
+        co_return value.value;
+    };
+
+    BOOST_TEST(Wait(call(10)) == 10);
+    BOOST_TEST((resumedThread != std::this_thread::get_id()));  // Resumed by the response delivery.
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,150 @@
+#include "stdafx.h"
+#include "IPC/Bond/DeserializationScheduler.h"
+#include "IPC/Bond/BufferPool.h"
+#include "IPC/detail/RandomString.h"
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace IPC::Bond;
+using IPC::detail::GenerateRandomString;
+using IPC::SharedMemory;
+using IPC::create_only;
+
+
+BOOST_AUTO_TEST_SUITE(DeserializationSchedulerTests)
+
+static_assert(std::is_copy_constructible<ThresholdDeserializationScheduler>::value, "ThresholdDeserializationScheduler should be copy constructible.");
+static_assert(std::is_default_constructible<ThresholdDeserializationScheduler>::value, "ThresholdDeserializationScheduler should be default constructible.");
+
+DefaultBufferPool::ConstBuffer MakeBuffer(DefaultBufferPool& pool, std::size_t size)
+{
+    auto buffer = pool.TakeBuffer();
+
+    auto blob = pool.TakeBlob();
+    blob->resize(size, boost::container::default_init);
+    buffer->push_back(std::move(blob));
+
+    return std::move(buffer);
+}
+
+BOOST_AUTO_TEST_CASE(InlineTest)
+{
+    auto pool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+
+    auto dispatcher = InlineDeserializationScheduler{}.MakeDispatcher();
+
+    auto threadId = std::this_thread::get_id();
+    std::thread::id calledOn;
+
+    dispatcher(MakeBuffer(*pool, 100), [&](DefaultBufferPool::ConstBuffer&& buffer) { calledOn = std::this_thread::get_id(); BOOST_TEST(buffer.size() == 100); });
+
+    BOOST_TEST((calledOn == threadId));
+}
+
+BOOST_AUTO_TEST_CASE(ThresholdTest)
+{
+    auto pool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+
+    ThresholdDeserializationScheduler scheduler{ std::make_shared<ThreadPool>(2), 1024, false };
+    BOOST_TEST(scheduler.GetThreshold() == 1024);
+    BOOST_TEST(!scheduler.IsOrderPreserved());
+
+    auto dispatcher = scheduler.MakeDispatcher();
+    auto threadId = std::this_thread::get_id();
+
+    {
+        std::thread::id calledOn;
+        dispatcher(MakeBuffer(*pool, 100), [&](DefaultBufferPool::ConstBuffer&& /*buffer*/) { calledOn = std::this_thread::get_id(); });
+        BOOST_TEST((calledOn == threadId));
+    }
+    {
+        std::promise<std::thread::id> calledOn;
+        dispatcher(MakeBuffer(*pool, 2048), [&](DefaultBufferPool::ConstBuffer&& buffer) { BOOST_TEST(buffer.size() == 2048); calledOn.set_value(std::this_thread::get_id()); });
+        BOOST_TEST((calledOn.get_future().get() != threadId));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(OrderTest)
+{
+    auto pool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+
+    ThresholdDeserializationScheduler scheduler{ std::make_shared<ThreadPool>(4), 1024 };
+    BOOST_TEST(scheduler.IsOrderPreserved());
+
+    auto dispatcher = scheduler.MakeDispatcher();
+
+    constexpr std::size_t count = 100;
+
+    std::mutex lock;
+    std::vector<std::size_t> order;
+    std::promise<void> done;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        dispatcher(
+            MakeBuffer(*pool, i % 3 == 0 ? 2048 : 16),
+            [&, i](DefaultBufferPool::ConstBuffer&& /*buffer*/)
+            {
+                std::lock_guard<std::mutex> guard{ lock };
+                order.push_back(i);
+
+                if (order.size() == count)
+                {
+                    done.set_value();
+                }
+            });
+    }
+
+    done.get_future().wait();
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        BOOST_TEST(order[i] == i);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ErrorTest)
+{
+    auto pool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+
+    for (auto preserveOrder : { false, true })
+    {
+        std::mutex lock;
+        std::vector<std::string> errors;
+        std::size_t delivered{ 0 };
+
+        auto threadPool = std::make_shared<ThreadPool>(
+            2,
+            [&](std::exception_ptr error)
+            {
+                try
+                {
+                    std::rethrow_exception(error);
+                }
+                catch (const std::exception& e)
+                {
+                    std::lock_guard<std::mutex> guard{ lock };
+                    errors.push_back(e.what());
+                }
+            });
+
+        {
+            auto dispatcher = ThresholdDeserializationScheduler{ threadPool, 1024, preserveOrder }.MakeDispatcher();
+
+            dispatcher(MakeBuffer(*pool, 2048), [](DefaultBufferPool::ConstBuffer&& /*buffer*/) { throw std::runtime_error{ "Failed." }; });
+            dispatcher(MakeBuffer(*pool, 2048), [&](DefaultBufferPool::ConstBuffer&& /*buffer*/) { std::lock_guard<std::mutex> guard{ lock }; ++delivered; });
+        }
+
+        threadPool.reset();     // Runs the remaining tasks and joins the threads.
+
+        BOOST_TEST(delivered == 1);
+        BOOST_TEST(errors.size() == 1);
+        BOOST_TEST(errors.front() == "Failed.");
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,146 @@
+#include "stdafx.h"
+#include "IPC/Bond/FlatCodec.h"
+#include "IPC/Bond/Serializer.h"
+#include "IPC/detail/RandomString.h"
+#include <bond/core/bond_types.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace IPC::Bond;
+using IPC::detail::GenerateRandomString;
+using IPC::SharedMemory;
+using IPC::create_only;
+
+
+BOOST_AUTO_TEST_SUITE(FlatCodecTests)
+
+using Strings = bond::Box<std::vector<bond::Box<std::string>>>;
+using Numbers = bond::Box<std::vector<std::uint32_t>>;
+
+template <typename T>
+using Value = typename T::Schema::var::value;
+
+Strings MakeStrings(std::size_t count)
+{
+    Strings strings;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        bond::Box<std::string> box;
+        box.value = std::to_string(i);
+        strings.value.push_back(std::move(box));
+    }
+
+    return strings;
+}
+
+BOOST_AUTO_TEST_CASE(ReadInPlaceTest)
+{
+    auto pool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+
+    FlatObject<Strings> strings{ *pool, MakeStrings(1000) };
+
+    BOOST_TEST(std::next(strings.GetBuffer().begin()) == strings.GetBuffer().end());
+
+    auto list = strings->Get<Value<Strings>>();
+    BOOST_TEST(list.size() == 1000);
+    BOOST_TEST(list[0].Get<Value<bond::Box<std::string>>>() == "0");
+    BOOST_TEST(list[999].Get<Value<bond::Box<std::string>>>() == "999");
+    BOOST_CHECK_THROW(list[1000], std::out_of_range);
+
+    Numbers numbers;
+    numbers.value = { 1, 2, 0xffffffff };
+
+    FlatObject<Numbers> flatNumbers{ *pool, numbers };
+    BOOST_TEST(flatNumbers->Get<Value<Numbers>>().size() == 3);
+    BOOST_TEST(flatNumbers->Get<Value<Numbers>>()[2] == 0xffffffff);
+
+    bond::Box<bond::ProtocolType> protocol;
+    protocol.value = bond::ProtocolType::FAST_PROTOCOL;
+
+    BOOST_TEST((FlatObject<bond::Box<bond::ProtocolType>>{ *pool, protocol }->Get<Value<bond::Box<bond::ProtocolType>>>() == bond::ProtocolType::FAST_PROTOCOL));
+}
+
+BOOST_AUTO_TEST_CASE(MissingFieldTest)
+{
+    // Table without fields, as written by an older schema.
+    const char payload[] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+
+    FlatView<bond::Box<double>> view{ payload, sizeof(payload), 0 };
+    BOOST_TEST(view.GetFieldCount() == 0);
+    BOOST_TEST(view.Get<Value<bond::Box<double>>>() == 0.0);
+
+    BOOST_TEST(FlatView<Strings>{}.Get<Value<Strings>>().empty());
+
+    using Text = bond::Box<std::string>;
+    using Nested = bond::Box<Text>;
+
+    BOOST_TEST((FlatView<Text>{ payload, sizeof(payload), 0 }.Get<Value<Text>>() == detail::GetDefault<Text>().value));
+
+    // Read from the encoded schema default, not an empty view.
+    auto nested = FlatView<Nested>{ payload, sizeof(payload), 0 }.Get<Value<Nested>>();
+    BOOST_TEST(nested.GetFieldCount() == 1);
+    BOOST_TEST(nested.Get<Value<Text>>().empty());
+}
+
+BOOST_AUTO_TEST_CASE(InvalidPayloadTest)
+{
+    auto pool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+
+    BOOST_CHECK_THROW((FlatObject<Strings>{ DefaultBufferPool::ConstBuffer{ pool->TakeBuffer() } }), std::invalid_argument);
+
+    {
+        auto buffer = pool->TakeBuffer();
+        auto blob = pool->TakeBlob();
+        blob->resize(16, 0);
+        buffer->push_back(std::move(blob));
+
+        BOOST_CHECK_THROW((FlatObject<Strings>{ std::move(buffer) }), std::invalid_argument);
+    }
+    {
+        auto valid = FlatSerialize(*pool, MakeStrings(3));
+        const auto& validBlob = *valid.begin();
+
+        auto blob = pool->TakeBlob();
+        blob->assign(validBlob.data(), validBlob.data() + validBlob.size());
+
+        // Point the list slot past the end of the blob.
+        const std::uint32_t offset = 1024;
+        std::memcpy(blob->data() + 16, &offset, sizeof(offset));
+
+        auto buffer = pool->TakeBuffer();
+        buffer->push_back(std::move(blob));
+
+        FlatObject<Strings> strings{ std::move(buffer) };
+        BOOST_CHECK_THROW(strings->Get<Value<Strings>>(), std::out_of_range);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(SerializerTest)
+{
+    auto pool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+    auto otherPool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+
+    FlatObject<Strings> strings{ *pool, MakeStrings(10) };
+
+    {
+        DefaultSerializer serializer{ bond::ProtocolType::COMPACT_PROTOCOL, true, pool, pool->GetMemory() };
+
+        auto buffer = serializer.Serialize(strings);
+        BOOST_TEST(buffer.begin()->data() == strings.GetBuffer().begin()->data());
+
+        FlatObject<Strings> result;
+        serializer.Deserialize(std::move(buffer), result);
+        BOOST_TEST(result->Get<Value<Strings>>()[9].Get<Value<bond::Box<std::string>>>() == "9");
+    }
+    {
+        DefaultSerializer serializer{ bond::ProtocolType::COMPACT_PROTOCOL, true, otherPool, otherPool->GetMemory() };
+
+        auto result = serializer.Deserialize<FlatObject<Strings>>(serializer.Serialize(strings)).get();
+        BOOST_TEST(otherPool->GetMemory()->Contains(result.GetBuffer().begin()->data()));
+        BOOST_TEST(result->Get<Value<Strings>>()[5].Get<Value<bond::Box<std::string>>>() == "5");
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,110 @@
+#include "stdafx.h"
+#include "IPC/Bond/InplaceFunction.h"
+#include "IPC/Bond/InplaceTraits.h"
+#include "IPC/detail/RandomString.h"
+#include <bond/core/bond_types.h>
+#include <array>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+using namespace IPC::Bond;
+using IPC::detail::GenerateRandomString;
+using IPC::SharedMemory;
+using IPC::create_only;
+
+
+BOOST_AUTO_TEST_SUITE(InplaceFunctionTests)
+
+static_assert(!std::is_copy_constructible<InplaceFunction<void()>>::value, "InplaceFunction should not be copy constructible.");
+static_assert(std::is_nothrow_move_constructible<InplaceFunction<void()>>::value, "InplaceFunction should be nothrow move constructible.");
+static_assert(std::is_nothrow_move_assignable<InplaceFunction<void()>>::value, "InplaceFunction should be nothrow move assignable.");
+
+BOOST_AUTO_TEST_CASE(MoveOnlyCallableTest)
+{
+    std::promise<std::string> promise;
+    auto result = promise.get_future();
+
+    InplaceFunction<void(std::string&&)> func{
+        [promise = std::move(promise)](std::string&& value) mutable { promise.set_value(std::move(value)); } };
+
+    BOOST_TEST(!!func);
+    BOOST_TEST(func.IsInline());
+
+    auto other = std::move(func);
+    BOOST_TEST(!func);
+    BOOST_TEST(other.IsInline());
+
+    other("value");
+    BOOST_TEST(result.get() == "value");
+}
+
+BOOST_AUTO_TEST_CASE(HeapFallbackTest)
+{
+    std::array<char, 100> large{};
+    large.back() = 'x';
+
+    InplaceFunction<char()> func{ [large] { return large.back(); } };
+    BOOST_TEST(!func.IsInline());
+    BOOST_TEST(func() == 'x');
+
+    InplaceFunction<char()> small{ [] { return 'y'; } };
+    BOOST_TEST(small.IsInline());
+
+    small = std::move(func);
+    BOOST_TEST(!func);
+    BOOST_TEST(small() == 'x');
+
+    BOOST_TEST((InplaceFunction<char(), 128>{ [large] { return large.back(); } }.IsInline()));
+}
+
+BOOST_AUTO_TEST_CASE(LifetimeTest)
+{
+    auto value = std::make_shared<int>(1);
+    {
+        InplaceFunction<int(int)> func{ [value](int x) { return *value + x; } };
+        BOOST_TEST(value.use_count() == 2);
+
+        auto other = std::move(func);
+        BOOST_TEST(value.use_count() == 2);
+        BOOST_TEST(other(2) == 3);
+
+        other = nullptr;
+        BOOST_TEST(value.use_count() == 1);
+    }
+    BOOST_TEST(value.use_count() == 1);
+
+    InplaceFunction<void()> empty;
+    BOOST_CHECK_THROW(empty(), std::bad_function_call);
+}
+
+BOOST_AUTO_TEST_CASE(TransactionCallbackTest)
+{
+    using Traits = InplaceCallbackTraits<>;
+    using ConstBuffer = DefaultBufferPool::ConstBuffer;
+    using Response = bond::Box<int>;
+    using Context = detail::InplaceContext<std::function<void(ConstBuffer&&)>, Traits::CallbackCapacity>::type;
+
+    static_assert(std::is_same<Context, InplaceFunction<void(ConstBuffer&&), Traits::CallbackCapacity>>::value,
+        "Transaction callbacks should be stored in InplaceFunction.");
+
+    auto pool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+    Traits::Serializer serializer{ bond::ProtocolType::COMPACT_PROTOCOL, true, pool, pool->GetMemory() };
+
+    auto result = std::make_shared<std::promise<Response>>();
+
+    // Captures the same state as the callback Client hands to the transport for a value callback.
+    auto func = [serializer, objects = Traits::ObjectPool<Response>{}, callback = [result](auto&& /*response*/) {}](ConstBuffer&& /*buffer*/) mutable {};
+
+    Context callback{
+        [dispatcher = Traits::DeserializationScheduler{}.MakeDispatcher(), func = std::move(func)](ConstBuffer&& buffer) mutable
+        {
+            dispatcher(std::move(buffer), std::move(func));
+        } };
+
+    BOOST_TEST(callback.IsInline());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
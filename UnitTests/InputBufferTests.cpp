@@ -149,6 +149,16 @@ BOOST_AUTO_TEST_CASE(ReadBondBlobTest)
     BOOST_TEST(BlobCast<DefaultBufferPool::ConstBlob>(b1).data() == constBuffer.begin()->data());
     BOOST_TEST(BlobCast<DefaultBufferPool::ConstBlob>(b2).data() == constBuffer.begin()->data() + 5);
     BOOST_TEST(BlobCast<DefaultBufferPool::ConstBlob>(b3).data() == std::next(constBuffer.begin())->data());
+
+    auto isSameHolder = [](const bond::blob& x, const bond::blob& y)
+    {
+        auto hx = bond::blob_cast<detail::BlobHook>(x);
+        auto hy = bond::blob_cast<detail::BlobHook>(y);
+        return !hx.owner_before(hy) && !hy.owner_before(hx);
+    };
+
+    BOOST_TEST(isSameHolder(b1, b2));
+    BOOST_TEST(!isSameHolder(b1, b3));
 }
 
 BOOST_AUTO_TEST_CASE(SkipTest)
@@ -419,6 +429,98 @@ BOOST_AUTO_TEST_CASE(CreateInputBufferTest)
     BOOST_TEST(std::all_of(result, result + 5, [](const char& c) { return c == 1; }));
 }
 
+BOOST_AUTO_TEST_CASE(BorrowTest)
+{
+    auto memory = std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024);
+    auto pool = std::make_shared<DefaultBufferPool>(memory);
+
+    auto buffer = pool->TakeBuffer();
+    {
+        auto blob = pool->TakeBlob();
+        blob->resize(10, 1);
+        buffer->push_back(std::move(blob));
+    }
+    {
+        auto blob = pool->TakeBlob();
+        blob->resize(10, 2);
+        buffer->push_back(std::move(blob));
+    }
+
+    DefaultBufferPool::ConstBuffer constBuffer{ std::move(buffer) };
+
+    DefaultInputBuffer input{ constBuffer, memory };
+    input.Skip(5);
+
+    const auto useCount = memory.use_count();
+
+    auto view = input.Borrow();
+    auto copy = view;
+
+    BOOST_TEST(!input.IsBorrowed());
+    BOOST_TEST(view.IsBorrowed());
+    BOOST_TEST(copy.IsBorrowed());
+    BOOST_TEST(memory.use_count() == useCount);
+    BOOST_TEST(view.GetMemory() == memory);
+    BOOST_TEST((view == input));
+
+    auto begin = GetCurrentBuffer(view);
+    view.Skip(10);
+
+    auto nested = CreateInputBuffer(view, GetBufferRange(begin, view));
+    BOOST_TEST(!nested.IsBorrowed());
+    BOOST_TEST(nested.GetMemory() == memory);
+
+    char result[10];
+    nested.Read(result, sizeof(result));
+    BOOST_TEST(nested.IsEof());
+    BOOST_TEST(std::all_of(result, result + 5, [](const char& c) { return c == 1; }));
+    BOOST_TEST(std::all_of(result + 5, result + 10, [](const char& c) { return c == 2; }));
+
+    bond::blob bondBlob;
+    view.Read(bondBlob, 5);
+    BOOST_TEST(view.IsEof());
+    BOOST_TEST(std::all_of(bondBlob.begin(), bondBlob.end(), [](const char& c) { return c == 2; }));
+    BOOST_TEST(BlobCast<DefaultBufferPool::ConstBlob>(bondBlob).data() == std::next(constBuffer.begin())->data() + 5);
+
+    auto nestedView = copy.Borrow();
+    BOOST_TEST(nestedView.GetMemory() == memory);
+    nestedView.Skip(15);
+    BOOST_TEST(nestedView.IsEof());
+    BOOST_TEST(!input.IsEof());
+}
+
+BOOST_AUTO_TEST_CASE(BorrowedHolderTest)
+{
+    auto memory = std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024);
+    auto pool = std::make_shared<DefaultBufferPool>(memory);
+
+    auto buffer = pool->TakeBuffer();
+    auto blob = pool->TakeBlob();
+    blob->resize(10, 1);
+    buffer->push_back(std::move(blob));
+
+    DefaultBufferPool::ConstBuffer constBuffer{ std::move(buffer) };
+
+    DefaultInputBuffer input{ constBuffer, memory };
+
+    const auto useCount = memory.use_count();
+
+    bond::blob first, second;
+    {
+        auto view = input.Borrow();
+        view.Read(first, 5);
+        BOOST_TEST(memory.use_count() == useCount + 1);
+    }
+
+    // The holder created through the view is kept by its owner and reused, copies start without one.
+    input.Read(second, 5);
+    BOOST_TEST(memory.use_count() == useCount + 1);
+
+    auto copy = input;
+    copy.Read(second, 5);
+    BOOST_TEST(memory.use_count() == useCount + 2);
+}
+
 BOOST_AUTO_TEST_CASE(MemoryOwnershipTest)
 {
     auto memory = std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024);
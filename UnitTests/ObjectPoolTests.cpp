@@ -0,0 +1,241 @@
+#include "stdafx.h"
+#include "IPC/Bond/ObjectPool.h"
+#include "IPC/Bond/Transport.h"
+#include "IPC/detail/RandomString.h"
+#include <bond/core/bond.h>
+#include <bond/core/bond_types.h>
+#include <bond/core/tuple.h>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+using namespace IPC::Bond;
+
+
+BOOST_AUTO_TEST_SUITE(ObjectPoolTests)
+
+using Object = bond::Box<std::vector<std::string>>;
+
+BOOST_AUTO_TEST_CASE(NoObjectPoolTest)
+{
+    NoObjectPool<Object> pool;
+
+    auto object = pool.Take();
+    BOOST_TEST(object->value.empty());
+}
+
+BOOST_AUTO_TEST_CASE(RecycleTest)
+{
+    RecyclingObjectPool<Object, 1> pool;
+
+    const Object* ptr;
+    {
+        auto object = pool.Take();
+        ptr = object.get();
+
+        object->value.assign(100, std::string(100, 'a'));
+    }
+
+    BOOST_TEST(pool.GetAvailableCount() == 1);
+
+    {
+        auto object = pool.Take();
+        BOOST_TEST(object.get() == ptr);
+        BOOST_TEST(object->value.empty());
+        BOOST_TEST(object->value.capacity() >= 100);
+
+        auto other = pool.Take();
+        BOOST_TEST(other.get() != ptr);
+    }
+
+    BOOST_TEST(pool.GetAvailableCount() == 1);
+}
+
+BOOST_AUTO_TEST_CASE(ResetTest)
+{
+    bond::Box<std::string> value;
+    value.value.assign(1000, 'a');
+
+    detail::ResetObject(value, detail::GetDefault<bond::Box<std::string>>());
+
+    BOOST_TEST(value.value.empty());
+    BOOST_TEST(value.value.capacity() >= 1000);
+
+    bond::Box<double> scalar;
+    scalar.value = 1.5;
+
+    detail::ResetObject(scalar, detail::GetDefault<bond::Box<double>>());
+
+    BOOST_TEST(scalar.value == 0);
+}
+
+// Shares one pool between all instances, so the test can tell when the server has given its request back.
+template <typename T>
+class SharedObjectPool : public RecyclingObjectPool<T, 1>
+{
+public:
+    SharedObjectPool()
+        : RecyclingObjectPool<T, 1>{ GetInstance() }
+    {}
+
+    static const RecyclingObjectPool<T, 1>& GetInstance()
+    {
+        static const RecyclingObjectPool<T, 1> s_pool;
+        return s_pool;
+    }
+};
+
+struct RecyclingTraits : DefaultTraits
+{
+    using TimeoutFactory = IPC::Policies::InfiniteTimeoutFactory;   // Using no-timeout to make these tests reliable.
+
+    template <typename Context>
+    using TransactionManager = IPC::Policies::TransactionManager<Context, TimeoutFactory>;
+
+    template <typename T>
+    using ObjectPool = SharedObjectPool<T>;
+};
+
+using Request = bond::Box<std::string>;
+using Response = std::tuple<std::string, std::uint64_t>;
+
+struct CapacityHandler
+{
+    template <typename Callback>
+    void operator()(Request&& request, Callback&& callback)
+    {
+        callback(Response{ request.value, request.value.capacity() });
+    }
+
+    template <typename Callback>
+    void operator()(std::exception_ptr /*error*/, Callback&& callback)
+    {
+        callback(Response{});
+    }
+};
+
+BOOST_AUTO_TEST_CASE(ServerRoundTripTest)
+{
+    using Transport = IPC::Bond::Transport<Request, Response, RecyclingTraits>;
+
+    Transport transport;
+
+    auto name = IPC::detail::GenerateRandomString();
+
+    std::mutex lock;
+    std::condition_variable serverInserted;
+    std::unique_ptr<Transport::Server> server;
+
+    auto acceptor = transport.MakeServerAcceptor(
+        name.c_str(),
+        [&](auto futureConnection)
+        {
+            std::lock_guard<std::mutex> guard{ lock };
+            server = transport.MakeServer(futureConnection.get(), [](auto&&...) { return CapacityHandler{}; }, [] {});
+            serverInserted.notify_one();
+        });
+
+    auto client = transport.MakeClient(transport.MakeClientConnector().Connect(name.c_str()).get(), [] {});
+
+    {
+        std::unique_lock<std::mutex> guard{ lock };
+        serverInserted.wait(guard, [&] { return !!server; });
+    }
+
+    const auto& requests = SharedObjectPool<Request>::GetInstance();
+
+    auto call = [&](const std::string& value)
+    {
+        Request request;
+        request.value = value;
+
+        auto response = (*client)(request).get();
+
+        // The response may arrive before the server handler has returned the request to the pool.
+        while (requests.GetAvailableCount() == 0)
+        {
+            std::this_thread::yield();
+        }
+
+        return response;
+    };
+
+    const std::string large(1000, 'a');
+
+    auto response = call(large);
+    BOOST_TEST(std::get<0>(response) == large);
+    BOOST_TEST(std::get<1>(response) >= large.size());
+
+    for (auto&& value : { std::string{ "b" }, std::string{}, std::string{ "cc" } })
+    {
+        response = call(value);
+        BOOST_TEST(std::get<0>(response) == value);
+        BOOST_TEST(std::get<1>(response) >= large.size());
+    }
+}
+
+struct DeferredHandler
+{
+    // Replies later from the test thread, the request must stay valid until then.
+    template <typename Callback>
+    void operator()(Request&& request, Callback&& callback)
+    {
+        auto reply = std::make_shared<std::decay_t<Callback>>(std::forward<Callback>(callback));
+
+        m_deferred->set_value([&request, reply] { (*reply)(Response{ request.value, request.value.capacity() }); });
+    }
+
+    template <typename Callback>
+    void operator()(std::exception_ptr /*error*/, Callback&& /*callback*/)
+    {}
+
+    std::shared_ptr<std::promise<std::function<void()>>> m_deferred;
+};
+
+BOOST_AUTO_TEST_CASE(DeferredResponseTest)
+{
+    using Transport = IPC::Bond::Transport<Request, Response, RecyclingTraits>;
+
+    Transport transport;
+
+    auto name = IPC::detail::GenerateRandomString();
+
+    auto deferred = std::make_shared<std::promise<std::function<void()>>>();
+    std::promise<std::unique_ptr<Transport::Server>> server;
+
+    auto acceptor = transport.MakeServerAcceptor(
+        name.c_str(),
+        [&](auto futureConnection)
+        {
+            server.set_value(transport.MakeServer(futureConnection.get(), [deferred](auto&&...) { return DeferredHandler{ deferred }; }, [] {}));
+        });
+
+    auto client = transport.MakeClient(transport.MakeClientConnector().Connect(name.c_str()).get(), [] {});
+    auto serverHolder = server.get_future().get();
+
+    const auto& requests = SharedObjectPool<Request>::GetInstance();
+
+    Request request;
+    request.value = "abc";
+
+    auto response = (*client)(request);
+    auto reply = deferred->get_future().get();
+
+    BOOST_TEST(requests.GetAvailableCount() == 0);
+
+    reply();
+    BOOST_TEST(std::get<0>(response.get()) == "abc");
+
+    // The request goes back to the pool with the callback.
+    reply = nullptr;
+    BOOST_TEST(requests.GetAvailableCount() == 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
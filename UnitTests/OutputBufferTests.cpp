@@ -1,8 +1,10 @@
 #include "stdafx.h"
 #include "IPC/Bond/OutputBuffer.h"
 #include "IPC/detail/RandomString.h"
+#include <algorithm>
 #include <tuple>
 #include <type_traits>
+#include <vector>
 
 using namespace IPC::Bond;
 using IPC::detail::GenerateRandomString;
@@ -292,6 +294,30 @@ BOOST_AUTO_TEST_CASE(WriteBondBlobWithPrivateMemoryTest)
     BOOST_TEST(*reinterpret_cast<const int*>(ptr) == 2);
 }
 
+BOOST_AUTO_TEST_CASE(WriteAlignedBondBlobTest)
+{
+    auto pool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+    DefaultOutputBuffer output{ pool, 0, 100 };
+
+    const std::vector<char> large(100, 'a');
+    const char small[] = "Data";
+
+    output.Write(static_cast<short>(1));
+    output.Write(bond::blob{ large.data(), static_cast<std::uint32_t>(large.size()) });
+    output.Write(bond::blob{ small, sizeof(small) });
+
+    auto buffer = std::move(output).GetBuffer();
+
+    BOOST_TEST(buffer.size() == sizeof(short) + large.size() + sizeof(small));
+    BOOST_TEST(std::distance(buffer.begin(), buffer.end()) == 2);
+
+    // Large payload starts the second blob, the small one follows it.
+    const auto& blob = *std::next(buffer.begin());
+    BOOST_TEST(reinterpret_cast<std::uintptr_t>(blob.data()) % 64 == 0);
+    BOOST_TEST(std::equal(large.begin(), large.end(), blob.data()));
+    BOOST_TEST(std::memcmp(blob.data() + large.size(), small, sizeof(small)) == 0);
+}
+
 BOOST_AUTO_TEST_CASE(WriteBondBlobWithSharedMemoryTest)
 {
     auto pool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
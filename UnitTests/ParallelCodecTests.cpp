@@ -0,0 +1,84 @@
+#include "stdafx.h"
+#include "IPC/Bond/ParallelCodec.h"
+#include "IPC/Bond/Serializer.h"
+#include "IPC/detail/RandomString.h"
+#include <bond/core/bond.h>
+#include <bond/core/bond_types.h>
+#include <bond/protocol/compact_binary.h>
+#include <bond/protocol/fast_binary.h>
+#include <string>
+#include <vector>
+
+
+using namespace IPC::Bond;
+using IPC::detail::GenerateRandomString;
+using IPC::SharedMemory;
+using IPC::create_only;
+
+
+BOOST_AUTO_TEST_SUITE(ParallelCodecTests)
+
+std::string ToString(const DefaultBufferPool::ConstBuffer& buffer)
+{
+    std::string result;
+
+    for (const auto& blob : buffer)
+    {
+        result.append(blob.data(), blob.size());
+    }
+
+    return result;
+}
+
+template <typename Encoding, typename T>
+void RunParallelSerializationTest(const std::shared_ptr<DefaultBufferPool>& pool, ThreadPool& threadPool, const T& obj, std::size_t minBlobCount)
+{
+    for (auto marshal : { false, true })
+    {
+        auto generic = marshal ? Marshal(Encoding::Protocol, pool, obj) : Serialize(Encoding::Protocol, pool, obj);
+        auto parallel = ParallelSerialize<Encoding>(pool, obj, marshal, threadPool, 100);
+
+        BOOST_TEST(static_cast<std::size_t>(std::distance(parallel.begin(), parallel.end())) >= minBlobCount);
+        BOOST_TEST(ToString(generic) == ToString(parallel));
+
+        T result;
+        DefaultSerializer{ Encoding::Protocol, marshal, pool, pool->GetMemory() }.Deserialize(std::move(parallel), result);
+        BOOST_TEST((result == obj));
+    }
+}
+
+template <typename T, typename Function>
+bond::Box<std::vector<T>> MakeList(std::size_t size, Function&& makeElement)
+{
+    bond::Box<std::vector<T>> list;
+
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        list.value.push_back(makeElement(i));
+    }
+
+    return list;
+}
+
+BOOST_AUTO_TEST_CASE(ParallelSerializationTest)
+{
+    auto pool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 16 * 1024 * 1024));
+    ThreadPool threadPool{ 4 };
+
+    auto structs = MakeList<bond::Box<std::int32_t>>(10000, [](std::size_t i) { bond::Box<std::int32_t> box; box.value = static_cast<std::int32_t>(i) - 5000; return box; });
+    auto strings = MakeList<std::string>(10000, [](std::size_t i) { return std::string(i % 17, 'x'); });
+    auto numbers = MakeList<std::uint64_t>(10000, [](std::size_t i) { return i * i; });
+
+    RunParallelSerializationTest<StaticCompactBinary>(pool, threadPool, structs, 5);
+    RunParallelSerializationTest<StaticFastBinary>(pool, threadPool, structs, 5);
+    RunParallelSerializationTest<StaticCompactBinary>(pool, threadPool, strings, 5);
+    RunParallelSerializationTest<StaticFastBinary>(pool, threadPool, strings, 5);
+    RunParallelSerializationTest<StaticCompactBinary>(pool, threadPool, numbers, 5);
+    RunParallelSerializationTest<StaticFastBinary>(pool, threadPool, numbers, 5);
+
+    // Short lists are encoded on the calling thread.
+    RunParallelSerializationTest<StaticCompactBinary>(pool, threadPool, MakeList<std::string>(150, [](std::size_t) { return "short"; }), 1);
+    RunParallelSerializationTest<StaticCompactBinary>(pool, threadPool, bond::Box<std::vector<std::string>>{}, 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,128 @@
+#include "stdafx.h"
+#include "IPC/Bond/RequestCoalescer.h"
+#include "IPC/Bond/BufferPool.h"
+#include "IPC/detail/RandomString.h"
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace IPC::Bond;
+using IPC::detail::GenerateRandomString;
+using IPC::SharedMemory;
+using IPC::create_only;
+
+
+BOOST_AUTO_TEST_SUITE(RequestCoalescerTests)
+
+using Coalescer = InFlightRequestCoalescer<DefaultBufferPool>;
+using Callback = std::function<void(DefaultBufferPool::ConstBuffer&&)>;
+
+DefaultBufferPool::ConstBuffer MakeBuffer(DefaultBufferPool& pool, const std::string& value)
+{
+    auto buffer = pool.TakeBuffer();
+
+    auto blob = pool.TakeBlob();
+    blob->assign(value.begin(), value.end());
+    buffer->push_back(std::move(blob));
+
+    return std::move(buffer);
+}
+
+BOOST_AUTO_TEST_CASE(CoalesceTest)
+{
+    auto pool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+
+    Coalescer coalescer;
+    std::vector<Callback> sent;
+    std::size_t received = 0;
+
+    auto send = [&](DefaultBufferPool::ConstBuffer&& /*request*/, auto&& callback)
+    {
+        sent.push_back([callback = std::make_shared<std::decay_t<decltype(callback)>>(std::move(callback))](DefaultBufferPool::ConstBuffer&& response)
+        {
+            (*callback)(std::move(response));
+        });
+    };
+
+    auto response = MakeBuffer(*pool, "response");
+
+    for (auto request : { "a", "b", "a", "a" })
+    {
+        coalescer(MakeBuffer(*pool, request), [&](DefaultBufferPool::ConstBuffer&& buffer) { BOOST_TEST((buffer == response)); ++received; }, send);
+    }
+
+    BOOST_TEST(sent.size() == 2);
+    BOOST_TEST(coalescer.GetInFlightCount() == 2);
+
+    sent[0](DefaultBufferPool::ConstBuffer{ response });
+    BOOST_TEST(received == 3);
+    BOOST_TEST(coalescer.GetInFlightCount() == 1);
+
+    coalescer(MakeBuffer(*pool, "a"), [&](DefaultBufferPool::ConstBuffer&& /*buffer*/) { ++received; }, send);
+    BOOST_TEST(sent.size() == 3);
+
+    sent[1](DefaultBufferPool::ConstBuffer{ response });
+    BOOST_TEST(received == 4);
+}
+
+BOOST_AUTO_TEST_CASE(FailingCallbackTest)
+{
+    auto pool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+
+    Coalescer coalescer;
+    std::vector<Callback> sent;
+    std::size_t received = 0;
+
+    auto send = [&](DefaultBufferPool::ConstBuffer&& /*request*/, auto&& callback)
+    {
+        sent.push_back([callback = std::make_shared<std::decay_t<decltype(callback)>>(std::move(callback))](DefaultBufferPool::ConstBuffer&& response)
+        {
+            (*callback)(std::move(response));
+        });
+    };
+
+    coalescer(MakeBuffer(*pool, "a"), [](DefaultBufferPool::ConstBuffer&& /*buffer*/) { throw std::runtime_error{ "Failed." }; }, send);
+    coalescer(MakeBuffer(*pool, "a"), [&](DefaultBufferPool::ConstBuffer&& /*buffer*/) { ++received; }, send);
+
+    // Every caller is served before the failure is propagated to the delivery thread.
+    BOOST_CHECK_THROW(sent[0](MakeBuffer(*pool, "response")), std::runtime_error);
+    BOOST_TEST(received == 1);
+    BOOST_TEST(coalescer.GetInFlightCount() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(DroppedTransactionTest)
+{
+    auto pool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+
+    Coalescer coalescer;
+    std::size_t sent = 0;
+    bool called = false;
+
+    auto drop = [&](DefaultBufferPool::ConstBuffer&& /*request*/, auto&& /*callback*/) { ++sent; };
+
+    coalescer(MakeBuffer(*pool, "a"), [&](DefaultBufferPool::ConstBuffer&& /*buffer*/) { called = true; }, drop);
+    BOOST_TEST(coalescer.GetInFlightCount() == 0);
+
+    coalescer(MakeBuffer(*pool, "a"), [&](DefaultBufferPool::ConstBuffer&& /*buffer*/) { called = true; }, drop);
+    BOOST_TEST(sent == 2);
+    BOOST_TEST(!called);
+}
+
+BOOST_AUTO_TEST_CASE(KeyExtractorTest)
+{
+    auto pool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+
+    InFlightRequestCoalescer<DefaultBufferPool, std::function<std::string(const DefaultBufferPool::ConstBuffer&)>> coalescer{
+        [](const DefaultBufferPool::ConstBuffer& /*request*/) { return std::string{}; } };
+
+    std::size_t sent = 0;
+    auto send = [&](DefaultBufferPool::ConstBuffer&& /*request*/, auto&& callback) { ++sent; callback(DefaultBufferPool::ConstBuffer{}); };
+
+    coalescer(MakeBuffer(*pool, "a"), [](DefaultBufferPool::ConstBuffer&& /*buffer*/) {}, send);
+    coalescer(MakeBuffer(*pool, "a"), [](DefaultBufferPool::ConstBuffer&& /*buffer*/) {}, send);
+
+    BOOST_TEST(sent == 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,205 @@
+#include "stdafx.h"
+#include "IPC/Bond/ResponseCache.h"
+#include "IPC/Bond/BufferPool.h"
+#include "IPC/detail/RandomString.h"
+#include <chrono>
+#include <string>
+#include <thread>
+
+using namespace IPC::Bond;
+using IPC::detail::GenerateRandomString;
+using IPC::SharedMemory;
+using IPC::create_only;
+
+
+BOOST_AUTO_TEST_SUITE(ResponseCacheTests)
+
+using Cache = LruResponseCache<DefaultBufferPool>;
+
+static_assert(std::is_copy_constructible<Cache>::value, "LruResponseCache should be copy constructible.");
+static_assert(std::is_default_constructible<Cache>::value, "LruResponseCache should be default constructible.");
+static_assert(std::is_copy_constructible<Cache::Store>::value, "LruResponseCache::Store should be copy constructible.");
+
+DefaultBufferPool::ConstBuffer MakeBuffer(DefaultBufferPool& pool, const std::string& value)
+{
+    auto buffer = pool.TakeBuffer();
+
+    auto blob = pool.TakeBlob();
+    blob->assign(value.begin(), value.end());
+    buffer->push_back(std::move(blob));
+
+    return std::move(buffer);
+}
+
+bool Lookup(const Cache::Store& store, const DefaultBufferPool::ConstBuffer& request, DefaultBufferPool::ConstBuffer& response, Cache::Store::Token& token)
+{
+    token = {};
+    return store.Find(request, token, response);
+}
+
+BOOST_AUTO_TEST_CASE(DisabledTest)
+{
+    auto pool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+
+    auto store = Cache{}.MakeStore();
+    auto request = MakeBuffer(*pool, "request");
+
+    Cache::Store::Token token;
+    DefaultBufferPool::ConstBuffer response;
+
+    BOOST_TEST(!Lookup(store, request, response, token));
+    store.Insert(std::move(token), MakeBuffer(*pool, "response"));
+    BOOST_TEST(!Lookup(store, request, response, token));
+    BOOST_TEST(store.GetCount() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(HitTest)
+{
+    auto pool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+
+    auto store = Cache{ 10, 0 }.MakeStore();
+    auto serialized = MakeBuffer(*pool, "response");
+
+    Cache::Store::Token token;
+    DefaultBufferPool::ConstBuffer response;
+
+    BOOST_TEST(!Lookup(store, MakeBuffer(*pool, "request"), response, token));
+    store.Insert(std::move(token), serialized);
+
+    BOOST_TEST(Lookup(store, MakeBuffer(*pool, "request"), response, token));
+    BOOST_TEST((response == serialized));
+
+    BOOST_TEST(!Lookup(store, MakeBuffer(*pool, "other request"), response, token));
+}
+
+BOOST_AUTO_TEST_CASE(BoundsTest)
+{
+    auto pool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+
+    Cache::Store::Token token;
+    DefaultBufferPool::ConstBuffer response;
+
+    {
+        auto store = Cache{ 2, 0 }.MakeStore();
+
+        for (auto key : { "a", "b", "a", "c" })
+        {
+            if (!Lookup(store, MakeBuffer(*pool, key), response, token))
+            {
+                store.Insert(std::move(token), MakeBuffer(*pool, key));
+            }
+        }
+
+        BOOST_TEST(store.GetCount() == 2);
+        BOOST_TEST(Lookup(store, MakeBuffer(*pool, "a"), response, token));
+        BOOST_TEST(!Lookup(store, MakeBuffer(*pool, "b"), response, token));
+        BOOST_TEST(Lookup(store, MakeBuffer(*pool, "c"), response, token));
+    }
+    {
+        auto store = Cache{ 0, 10 }.MakeStore();
+
+        Lookup(store, MakeBuffer(*pool, "a"), response, token);
+        store.Insert(std::move(token), MakeBuffer(*pool, "0123456789A"));
+        BOOST_TEST(store.GetCount() == 0);
+
+        Lookup(store, MakeBuffer(*pool, "a"), response, token);
+        store.Insert(std::move(token), MakeBuffer(*pool, "012345"));
+        Lookup(store, MakeBuffer(*pool, "b"), response, token);
+        store.Insert(std::move(token), MakeBuffer(*pool, "012345"));
+        BOOST_TEST(store.GetCount() == 1);
+        BOOST_TEST(Lookup(store, MakeBuffer(*pool, "b"), response, token));
+
+        // Keys are counted as well.
+        Lookup(store, MakeBuffer(*pool, "0123456789"), response, token);
+        store.Insert(std::move(token), MakeBuffer(*pool, "x"));
+        BOOST_TEST(!Lookup(store, MakeBuffer(*pool, "0123456789"), response, token));
+        BOOST_TEST(store.GetCount() == 1);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ExpirationTest)
+{
+    auto pool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+
+    auto store = Cache{ 10, 0, std::chrono::milliseconds{ 10 } }.MakeStore();
+
+    Cache::Store::Token token;
+    DefaultBufferPool::ConstBuffer response;
+
+    Lookup(store, MakeBuffer(*pool, "request"), response, token);
+    store.Insert(std::move(token), MakeBuffer(*pool, "response"));
+    BOOST_TEST(Lookup(store, MakeBuffer(*pool, "request"), response, token));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{ 20 });
+
+    BOOST_TEST(!Lookup(store, MakeBuffer(*pool, "request"), response, token));
+    BOOST_TEST(store.GetCount() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(InvalidationTest)
+{
+    auto pool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+
+    Cache cache{ 10, 0, {}, [](const DefaultBufferPool::ConstBuffer& request) { return Cache::MakeKey(request).substr(0, 1); } };
+    auto store1 = cache.MakeStore();
+    auto store2 = cache.MakeStore();
+
+    Cache::Store::Token token;
+    DefaultBufferPool::ConstBuffer response;
+
+    for (const auto& store : { store1, store2 })
+    {
+        for (auto key : { "a1", "b1" })
+        {
+            Lookup(store, MakeBuffer(*pool, key), response, token);
+            store.Insert(std::move(token), MakeBuffer(*pool, key));
+        }
+
+        BOOST_TEST(Lookup(store, MakeBuffer(*pool, "a2"), response, token));
+    }
+
+    cache.Invalidate("a");
+
+    for (const auto& store : { store1, store2 })
+    {
+        BOOST_TEST(!Lookup(store, MakeBuffer(*pool, "a1"), response, token));
+        BOOST_TEST(Lookup(store, MakeBuffer(*pool, "b1"), response, token));
+    }
+
+    Lookup(store1, MakeBuffer(*pool, "a1"), response, token);
+    cache.Clear();
+    store1.Insert(std::move(token), MakeBuffer(*pool, "stale"));
+
+    BOOST_TEST(store1.GetCount() == 0);
+    BOOST_TEST(store2.GetCount() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(PeerReferenceTest)
+{
+    auto pool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+    auto peerPool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+
+    pool->EnablePeerReferences(peerPool->GetMemory(), 0);
+    detail::ProtocolNegotiation::AdvertisePeerReferences(*peerPool->GetMemory());
+
+    auto blob = peerPool->TakeBlob();
+    blob->assign(100, 'a');
+
+    auto buffer = pool->TakeBuffer();
+    buffer->push_back(pool->MakeReference(DefaultBufferPool::ConstBlob{ std::move(blob) }));
+    DefaultBufferPool::ConstBuffer request{ std::move(buffer) };
+    BOOST_TEST(request.begin()->IsReference());
+
+    auto store = Cache{ 10, 0 }.MakeStore();
+
+    Cache::Store::Token token;
+    DefaultBufferPool::ConstBuffer response;
+
+    // The reference may denote other content once its pin is reused, so the request is not cached.
+    BOOST_TEST(!Lookup(store, request, response, token));
+    store.Insert(std::move(token), MakeBuffer(*pool, "response"));
+    BOOST_TEST(!Lookup(store, request, response, token));
+    BOOST_TEST(store.GetCount() == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
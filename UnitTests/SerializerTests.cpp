@@ -9,6 +9,7 @@
 #include <bond/protocol/fast_binary.h>
 #include <bond/protocol/simple_json_reader.h>
 #include <bond/protocol/simple_json_writer.h>
+#include <chrono>
 #include <string>
 #include <vector>
 #include <map>
@@ -280,6 +281,79 @@ BOOST_AUTO_TEST_CASE(TranscodingTest)
         });
 }
 
+BOOST_AUTO_TEST_CASE(TranscodeTest)
+{
+    auto pool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+
+    auto obj = MakeStruct(*pool);
+
+    auto protocols =
+    {
+        bond::ProtocolType::COMPACT_PROTOCOL,
+        bond::ProtocolType::FAST_PROTOCOL,
+        bond::ProtocolType::SIMPLE_PROTOCOL
+    };
+
+    for (auto fromProtocol : protocols)
+    {
+        for (auto toProtocol : protocols)
+        {
+            auto buffer = Transcode<Struct>(fromProtocol, Serialize(fromProtocol, pool, obj), toProtocol, pool, pool->GetMemory());
+
+            Struct result;
+            Deserialize(toProtocol, std::move(buffer), result, pool->GetMemory());
+
+            BOOST_TEST((result == obj));
+        }
+    }
+
+    BOOST_CHECK_THROW(
+        Transcode<Struct>(bond::ProtocolType::COMPACT_PROTOCOL, Serialize(bond::ProtocolType::COMPACT_PROTOCOL, pool, obj), bond::ProtocolType::MARSHALED_PROTOCOL, pool, pool->GetMemory()),
+        std::exception);
+}
+
+// Compares transcoding against the deserialize and reserialize route, run explicitly with --run_test=SerializerTests/TranscodeBenchmark.
+BOOST_AUTO_TEST_CASE(TranscodeBenchmark, *boost::unit_test::disabled())
+{
+    auto pool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 64 * 1024 * 1024));
+
+    auto obj = MakeStruct(*pool);
+    std::get<1>(obj).resize(10000, std::get<0>(obj));
+
+    const auto fromProtocol = bond::ProtocolType::FAST_PROTOCOL;
+    const auto toProtocol = bond::ProtocolType::COMPACT_PROTOCOL;
+    const auto input = Serialize(fromProtocol, pool, obj);
+    const std::size_t iterations = 100;
+
+    auto measure = [&](auto&& func)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        for (std::size_t i = 0; i < iterations; ++i)
+        {
+            func();
+        }
+
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count() / iterations;
+    };
+
+    auto transcode = measure(
+        [&]
+        {
+            Transcode<Struct>(fromProtocol, input, toProtocol, pool, pool->GetMemory());
+        });
+
+    auto reserialize = measure(
+        [&]
+        {
+            Struct value;
+            Deserialize(fromProtocol, input, value, pool->GetMemory());
+            Serialize(toProtocol, pool, value);
+        });
+
+    BOOST_TEST_MESSAGE("Transcode: " << transcode << "us, deserialize and serialize: " << reserialize << "us per " << input.size() << " bytes.");
+}
+
 BOOST_AUTO_TEST_CASE(FailedDeserializationTest)
 {
     auto pool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
@@ -339,4 +413,136 @@ BOOST_AUTO_TEST_CASE(MemoryOwnershipTest)
     BOOST_TEST(memory.unique());
 }
 
+BOOST_AUTO_TEST_CASE(AlignedBlobTest)
+{
+    auto pool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+
+    std::vector<float> tile(1024, 1.0f);
+
+    bond::Box<bond::blob> obj;
+    obj.value = { tile.data(), static_cast<std::uint32_t>(tile.size() * sizeof(float)) };
+
+    for (auto marshal : { false, true })
+    {
+        DefaultSerializer serializer{ bond::ProtocolType::COMPACT_PROTOCOL, marshal, pool, pool->GetMemory(), 0, 1024 };
+
+        decltype(obj) result;
+        serializer.Deserialize(serializer.Serialize(obj), result);
+
+        BOOST_TEST((result == obj));
+        BOOST_TEST(pool->GetMemory()->Contains(result.value.content()));
+        BOOST_TEST(reinterpret_cast<std::uintptr_t>(result.value.content()) % 64 == 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(PeerReferenceTest)
+{
+    auto pool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+    auto peerPool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+    pool->EnablePeerReferences(peerPool->GetMemory(), 16);
+    detail::ProtocolNegotiation::AdvertisePeerReferences(*peerPool->GetMemory());
+
+    DefaultSerializer serializer{ bond::ProtocolType::COMPACT_PROTOCOL, true, pool, peerPool->GetMemory() };
+    DefaultSerializer peerSerializer{ bond::ProtocolType::COMPACT_PROTOCOL, true, peerPool, pool->GetMemory() };
+
+    // Blob received from the peer is sent back to it.
+    auto obj = MakeStruct(*peerPool);
+
+    Struct result;
+    peerSerializer.Deserialize(serializer.Serialize(obj), result);
+
+    BOOST_TEST((result == obj));
+    BOOST_TEST(std::get<8>(std::get<0>(result)).content() == std::get<8>(std::get<0>(obj)).content());
+    BOOST_TEST(pool->GetMemory()->Contains(std::get<10>(std::get<0>(result)).content()));    // Linked from the input memory, not copied.
+}
+
+BOOST_AUTO_TEST_CASE(ProtocolNegotiationTest)
+{
+    auto makePool = [] { return std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024)); };
+
+    auto check = [&](bond::ProtocolType protocol, bond::ProtocolType peerProtocol, bool peerNegotiates, bool headerless)
+    {
+        auto pool = makePool();
+        auto peerPool = makePool();
+
+        DefaultSerializer serializer{ protocol, true, pool, peerPool->GetMemory() };
+        serializer.Negotiate();
+
+        DefaultSerializer peerSerializer{ peerProtocol, true, peerPool, pool->GetMemory() };
+        DefaultSerializer peerCopy = peerSerializer;
+
+        if (peerNegotiates)
+        {
+            peerSerializer.Negotiate();
+            peerCopy = peerSerializer;
+        }
+
+        auto obj = MakeStruct(*pool);
+        auto buffer = serializer.Serialize(obj);
+
+        BOOST_TEST(serializer.IsMarshaled());
+        BOOST_TEST(buffer.size() == Marshal(protocol, pool, obj).size() - (headerless ? 4 : 0));
+
+        Struct result;
+        peerCopy.Deserialize(std::move(buffer), result);
+        BOOST_TEST((result == obj));
+
+        auto peerObj = MakeStruct(*peerPool);
+        result = {};
+        serializer.Deserialize(peerCopy.Serialize(peerObj), result);
+        BOOST_TEST((result == peerObj));
+    };
+
+    check(bond::ProtocolType::COMPACT_PROTOCOL, bond::ProtocolType::COMPACT_PROTOCOL, true, true);
+    check(bond::ProtocolType::FAST_PROTOCOL, bond::ProtocolType::FAST_PROTOCOL, true, true);
+    check(bond::ProtocolType::SIMPLE_PROTOCOL, bond::ProtocolType::SIMPLE_PROTOCOL, true, true);
+    check(bond::ProtocolType::COMPACT_PROTOCOL, bond::ProtocolType::FAST_PROTOCOL, true, false);
+    check(bond::ProtocolType::COMPACT_PROTOCOL, bond::ProtocolType::COMPACT_PROTOCOL, false, false);
+}
+
+BOOST_AUTO_TEST_CASE(DisableHeaderlessTest)
+{
+    auto makePool = [] { return std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024)); };
+    auto protocol = bond::ProtocolType::COMPACT_PROTOCOL;
+
+    {
+        auto pool = makePool();
+        auto peerPool = makePool();
+
+        DefaultSerializer serializer{ protocol, true, pool, peerPool->GetMemory() };
+        serializer.Negotiate();
+
+        DefaultSerializer peerSerializer{ protocol, true, peerPool, pool->GetMemory() };
+        peerSerializer.Negotiate();
+
+        BOOST_TEST(serializer.DisableHeaderless());
+
+        auto obj = MakeStruct(*pool);
+        BOOST_TEST(serializer.Serialize(obj).size() == Marshal(protocol, pool, obj).size());
+
+        // The peer no longer finds a matching descriptor and keeps the header as well.
+        auto peerObj = MakeStruct(*peerPool);
+        auto buffer = peerSerializer.Serialize(peerObj);
+        BOOST_TEST(buffer.size() == Marshal(protocol, peerPool, peerObj).size());
+
+        Struct result;
+        serializer.Deserialize(std::move(buffer), result);
+        BOOST_TEST((result == peerObj));
+    }
+    {
+        auto pool = makePool();
+        auto peerPool = makePool();
+
+        DefaultSerializer serializer{ protocol, true, pool, peerPool->GetMemory() };
+        serializer.Negotiate();
+
+        DefaultSerializer peerSerializer{ protocol, true, peerPool, pool->GetMemory() };
+        peerSerializer.Negotiate();
+
+        // Too late once headerless messages were sent.
+        serializer.Serialize(MakeStruct(*pool));
+        BOOST_TEST(!serializer.DisableHeaderless());
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
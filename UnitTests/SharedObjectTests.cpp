@@ -0,0 +1,93 @@
+#include "stdafx.h"
+#include "IPC/Bond/SharedObject.h"
+#include "IPC/Bond/Serializer.h"
+#include "IPC/detail/RandomString.h"
+#include <boost/container/string.hpp>
+#include <boost/container/vector.hpp>
+
+using namespace IPC::Bond;
+using IPC::detail::GenerateRandomString;
+using IPC::SharedMemory;
+using IPC::create_only;
+
+
+BOOST_AUTO_TEST_SUITE(SharedObjectTests)
+
+struct Object
+{
+    using allocator_type = SharedObjectAllocator<char>;
+    using String = boost::container::basic_string<char, std::char_traits<char>, SharedObjectAllocator<char>>;
+
+    explicit Object(const allocator_type& allocator)
+        : m_string{ allocator },
+          m_strings{ allocator }
+    {}
+
+    String m_string;
+    boost::container::vector<String, SharedObjectAllocator<String>> m_strings;
+    int m_value{ 0 };
+};
+
+SharedObject<Object> MakeObject(DefaultBufferPool& pool)
+{
+    SharedObjectWriter<Object> writer{ pool, 64 * 1024 };
+
+    writer->m_string.assign(200, 'a');
+    writer->m_value = 7;
+
+    for (int i = 0; i < 50; ++i)
+    {
+        writer->m_strings.emplace_back(100, 'b', writer->m_strings.get_allocator());
+    }
+
+    return std::move(writer).Finish();
+}
+
+BOOST_AUTO_TEST_CASE(WriterTest)
+{
+    auto pool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+
+    auto object = MakeObject(*pool);
+    BOOST_TEST(!!object);
+    BOOST_TEST(object->m_string.size() == 200);
+    BOOST_TEST(object->m_strings.size() == 50);
+    BOOST_TEST(object->m_strings[49][99] == 'b');
+    BOOST_TEST(object->m_value == 7);
+    BOOST_TEST(pool->GetMemory()->Contains(object->m_strings[49].data()));
+
+    SharedObjectWriter<Object> small{ *pool, 256 };
+    BOOST_CHECK_THROW(small->m_string.assign(1000, 'c'), std::bad_alloc);
+
+    BOOST_CHECK_THROW((SharedObject<Object>{ DefaultBufferPool::ConstBuffer{ pool->TakeBuffer() } }), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(SerializerTest)
+{
+    auto pool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+    auto otherPool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+
+    auto object = MakeObject(*pool);
+
+    {
+        DefaultSerializer serializer{ bond::ProtocolType::COMPACT_PROTOCOL, true, pool, pool->GetMemory() };
+
+        auto buffer = serializer.Serialize(object);
+        BOOST_TEST(buffer.begin()->data() == object.GetBuffer().begin()->data());
+
+        SharedObject<Object> result;
+        serializer.Deserialize(std::move(buffer), result);
+        BOOST_TEST(&*result == &*object);
+    }
+    {
+        DefaultSerializer serializer{ bond::ProtocolType::COMPACT_PROTOCOL, true, otherPool, otherPool->GetMemory() };
+
+        auto result = serializer.Deserialize<SharedObject<Object>>(serializer.Serialize(object)).get();
+        BOOST_TEST(&*result != &*object);
+        BOOST_TEST(otherPool->GetMemory()->Contains(&*result));
+        BOOST_TEST(otherPool->GetMemory()->Contains(result->m_strings[10].data()));
+        BOOST_TEST((result->m_strings[10] == object->m_strings[10]));
+        BOOST_TEST(result->m_value == object->m_value);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,202 @@
+#include "stdafx.h"
+#include "IPC/Bond/Serializer.h"
+#include "IPC/Bond/StaticCodec.h"
+#include "IPC/detail/RandomString.h"
+#include <bond/core/bond.h>
+#include <bond/core/bond_types.h>
+#include <bond/core/tuple.h>
+#include <bond/protocol/compact_binary.h>
+#include <bond/protocol/fast_binary.h>
+#include <limits>
+#include <string>
+#include <tuple>
+
+
+// Mirrors the code generated by gbc for: struct RequiredValue { 0: required int32 value; }
+struct RequiredValue
+{
+    std::int32_t value{ 0 };
+
+    struct Schema
+    {
+        typedef bond::no_base base;
+
+        static const bond::Metadata metadata;
+
+    private:
+        static const bond::Metadata s_value_metadata;
+
+    public:
+        struct var
+        {
+            typedef struct value_type : bond::reflection::FieldTemplate<
+                0,
+                bond::reflection::required_field_modifier,
+                RequiredValue,
+                std::int32_t,
+                &RequiredValue::value,
+                &s_value_metadata
+            > {} value;
+        };
+
+        typedef bond::detail::mpl::list<var::value> fields;
+
+        static bond::Metadata GetMetadata()
+        {
+            return bond::reflection::MetadataInit("RequiredValue", "UnitTests.RequiredValue", bond::reflection::Attributes());
+        }
+    };
+};
+
+const bond::Metadata RequiredValue::Schema::metadata = RequiredValue::Schema::GetMetadata();
+
+const bond::Metadata RequiredValue::Schema::s_value_metadata =
+    bond::reflection::MetadataInit("value", bond::reflection::required_field_modifier::value, bond::reflection::Attributes());
+
+
+namespace IPC
+{
+namespace Bond
+{
+    template <> struct EnableStaticCodec<RequiredValue> : std::true_type {};
+    template <> struct EnableStaticCodec<bond::Box<bool>> : std::true_type {};
+    template <> struct EnableStaticCodec<bond::Box<std::int8_t>> : std::true_type {};
+    template <> struct EnableStaticCodec<bond::Box<std::int32_t>> : std::true_type {};
+    template <> struct EnableStaticCodec<bond::Box<std::int64_t>> : std::true_type {};
+    template <> struct EnableStaticCodec<bond::Box<std::uint16_t>> : std::true_type {};
+    template <> struct EnableStaticCodec<bond::Box<std::uint64_t>> : std::true_type {};
+    template <> struct EnableStaticCodec<bond::Box<float>> : std::true_type {};
+    template <> struct EnableStaticCodec<bond::Box<double>> : std::true_type {};
+    template <> struct EnableStaticCodec<bond::Box<std::string>> : std::true_type {};
+    template <> struct EnableStaticCodec<bond::Box<bond::ProtocolType>> : std::true_type {};
+
+} // Bond
+} // IPC
+
+
+using namespace IPC::Bond;
+using IPC::detail::GenerateRandomString;
+using IPC::SharedMemory;
+using IPC::create_only;
+
+
+BOOST_AUTO_TEST_SUITE(StaticCodecTests)
+
+std::string ToString(const DefaultBufferPool::ConstBuffer& buffer)
+{
+    std::string result;
+
+    for (const auto& blob : buffer)
+    {
+        result.append(blob.data(), blob.size());
+    }
+
+    return result;
+}
+
+template <typename T>
+bond::Box<T> MakeBox(T value)
+{
+    bond::Box<T> box;
+    box.value = std::move(value);
+    return box;
+}
+
+template <typename T>
+void RunWireCompatibilityTest(const std::shared_ptr<DefaultBufferPool>& pool, const bond::Box<T>& obj)
+{
+    for (auto protocol : { bond::ProtocolType::COMPACT_PROTOCOL, bond::ProtocolType::FAST_PROTOCOL })
+    {
+        for (auto marshal : { false, true })
+        {
+            DefaultSerializer serializer{ protocol, marshal, pool, pool->GetMemory() };
+
+            auto generic = marshal ? Marshal(protocol, pool, obj) : Serialize(protocol, pool, obj);
+            auto specialized = serializer.Serialize(obj);
+
+            BOOST_TEST(ToString(generic) == ToString(specialized));
+
+            bond::Box<T> result;
+            marshal ? Unmarshal(specialized, result, pool->GetMemory()) : Deserialize(protocol, specialized, result, pool->GetMemory());
+            BOOST_TEST((result == obj));
+
+            result = {};
+            serializer.Deserialize(std::move(generic), result);
+            BOOST_TEST((result == obj));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(WireCompatibilityTest)
+{
+    auto pool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+
+    RunWireCompatibilityTest(pool, MakeBox(true));
+    RunWireCompatibilityTest(pool, MakeBox(false));
+    RunWireCompatibilityTest(pool, MakeBox<std::int8_t>(-8));
+    RunWireCompatibilityTest(pool, MakeBox<std::int32_t>(-123456));
+    RunWireCompatibilityTest(pool, MakeBox<std::int32_t>(0));
+    RunWireCompatibilityTest(pool, MakeBox<std::int64_t>(std::numeric_limits<std::int64_t>::min()));
+    RunWireCompatibilityTest(pool, MakeBox<std::uint16_t>(1000));
+    RunWireCompatibilityTest(pool, MakeBox<std::uint64_t>(std::numeric_limits<std::uint64_t>::max()));
+    RunWireCompatibilityTest(pool, MakeBox(1.5f));
+    RunWireCompatibilityTest(pool, MakeBox(-2.25));
+    RunWireCompatibilityTest(pool, MakeBox(std::string{ "Random string value" }));
+    RunWireCompatibilityTest(pool, MakeBox(std::string{}));
+    RunWireCompatibilityTest(pool, MakeBox(bond::ProtocolType::FAST_PROTOCOL));
+}
+
+BOOST_AUTO_TEST_CASE(FallbackTest)
+{
+    auto pool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+
+    std::tuple<float, std::string> obj{ 3.5f, "Unknown field" };
+
+    for (auto protocol : { bond::ProtocolType::COMPACT_PROTOCOL, bond::ProtocolType::FAST_PROTOCOL })
+    {
+        for (auto marshal : { false, true })
+        {
+            DefaultSerializer serializer{ protocol, marshal, pool, pool->GetMemory() };
+
+            bond::Box<float> result;
+            serializer.Deserialize(marshal ? Marshal(protocol, pool, obj) : Serialize(protocol, pool, obj), result);
+            BOOST_TEST(result.value == std::get<0>(obj));
+        }
+    }
+
+    DefaultSerializer compactSerializer{ bond::ProtocolType::COMPACT_PROTOCOL, true, pool, pool->GetMemory() };
+    DefaultSerializer fastSerializer{ bond::ProtocolType::FAST_PROTOCOL, true, pool, pool->GetMemory() };
+
+    auto box = MakeBox(std::string{ "Marshaled with other protocol" });
+
+    bond::Box<std::string> result;
+    fastSerializer.Deserialize(compactSerializer.Serialize(box), result);
+    BOOST_TEST((result == box));
+}
+
+BOOST_AUTO_TEST_CASE(RequiredFieldTest)
+{
+    auto pool = std::make_shared<DefaultBufferPool>(std::make_shared<SharedMemory>(create_only, GenerateRandomString().c_str(), 1024 * 1024));
+
+    for (auto protocol : { bond::ProtocolType::COMPACT_PROTOCOL, bond::ProtocolType::FAST_PROTOCOL })
+    {
+        for (auto marshal : { false, true })
+        {
+            DefaultSerializer serializer{ protocol, marshal, pool, pool->GetMemory() };
+
+            RequiredValue obj;
+            obj.value = 5;
+
+            RequiredValue result;
+            serializer.Deserialize(serializer.Serialize(obj), result);
+            BOOST_TEST(result.value == obj.value);
+
+            // Same failure as bond::Deserialize when the field is missing.
+            BOOST_CHECK_THROW(
+                serializer.Deserialize(marshal ? Marshal(protocol, pool, bond::Void{}) : Serialize(protocol, pool, bond::Void{}), result),
+                bond::CoreException);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()